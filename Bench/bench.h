@@ -0,0 +1,46 @@
+#pragma once
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+* Shortest time of runs calls to fn(), in seconds.  The shortest run is the one
+* least disturbed by the rest of the system, so it is the one compared.
+*/
+template<typename func>
+double best_time(int runs, func fn) {
+    double best = 1e300;
+    for (int r = 0; r < runs; r++) {
+        auto start = chrono::steady_clock::now();
+        fn();
+        double t = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        best = t < best ? t : best;
+    }
+    return best;
+}
+
+//results are added here so the compiler can't drop the work that made them
+extern volatile double bench_sink;
+
+/*
+* A benchmark, run as "Bench <name> [args...]".  Each one prints its own table.
+*/
+struct bench_case {
+    const char* name;
+    void (*run)(const vector<string>& args);
+    const char* about;
+};
+
+//each is defined in bench_<name>.cpp
+void bench_transform(const vector<string>& args);
+void bench_alloc(const vector<string>& args);
+void bench_gemm(const vector<string>& args);
+void bench_inverse(const vector<string>& args);
+void bench_precision(const vector<string>& args);
+
+#endif
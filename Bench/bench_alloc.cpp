@@ -0,0 +1,134 @@
+#include "bench.h"
+#include "camera.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+/*
+* Every allocation in the program goes through these, so a benchmark can count
+* the allocations made by the code between two reads of the counter.
+*/
+static std::atomic<long long> num_allocations(0);
+
+void* operator new(size_t size) {
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+/*
+* Perspective projection of one vertex onto the plane through pos with the given
+* normal, seen from focal, in image coordinates given by the rows of P.  This is
+* what camera::proj computed when every vec was a heap matrix.
+*/
+struct heap_projection {
+    matrix<realnum> P;
+    matrix<realnum> focal;
+    matrix<realnum> pos;
+    matrix<realnum> normal;
+    realnum focal_dist;
+
+    realnum scale(const matrix<realnum>& v) const {
+        realnum depth = 0;
+        for (int k = 0; k < 3; k++) {
+            depth += (v[k][0] - focal[k][0]) * normal[k][0];
+        }
+        return this->focal_dist / depth;
+    }
+
+    //each step stored in a named temporary
+    matrix<realnum> stepwise(const matrix<realnum>& v) const {
+        matrix<realnum> dir = v - this->focal;
+        matrix<realnum> on_plane = dir * this->scale(v);
+        matrix<realnum> rel = on_plane + this->focal - this->pos;
+        matrix<realnum> image = this->P * rel;
+        return image;
+    }
+
+    //the same as one expression, into destinations kept between calls
+    void fused(const matrix<realnum>& v, matrix<realnum>& rel, matrix<realnum>& image) const {
+        rel = (v - this->focal) * this->scale(v) + this->focal - this->pos;
+        image = this->P * rel;
+    }
+};
+
+/*
+* Heap allocations and time per projected vertex, through the heap matrix path
+* (stepwise and as fused expressions), camera::proj and camera::proj_points.
+*
+* Args: [number of vertices] (default 20000).
+*/
+void bench_alloc(const vector<string>& args) {
+    int n = args.size() > 0 ? atoi(args[0].c_str()) : 20000;
+    const int runs = 5;
+
+    camera cam(vec({ 0.5, 0.5, 0 }), vec({ -300, -300, 50 }), 400);
+    cam.rotate(0.1, 0.05);
+
+    point_buffer<realnum> points(n);
+    vector<matrix<realnum>> heap_points(n);
+    for (int i = 0; i < n; i++) {
+        points.set(i, vec({ (realnum)(50 * sin(i * 0.1)), (realnum)(50 * cos(i * 0.37)), (realnum)(i % 100) }));
+        heap_points[i] = points[i].dynamic();
+    }
+
+    heap_projection heap;
+    fixed_matrix<realnum, 2, 3> plane_proj = cam.R2_proj();
+    heap.P = plane_proj.dynamic();
+    heap.focal = cam.get_focal_point().dynamic();
+    heap.pos = cam.get_pos().dynamic();
+    heap.normal = cam.get_normal().dynamic();
+    heap.focal_dist = cam.get_foc_dist();
+
+    //each path is timed, then run once more between two reads of the counter
+    const char* names[4] = { "heap stepwise", "heap fused", "camera::proj", "proj_points" };
+    double times[4];
+    long long allocations[4];
+    for (int path = 0; path < 4; path++) {
+        matrix<realnum> rel(3, 1), image(2, 1);
+        vector<vec2> images(n);
+        auto project_all = [&]() {
+            realnum sum = 0;
+            switch (path) {
+            case 0:
+                for (int i = 0; i < n; i++) {
+                    sum += heap.stepwise(heap_points[i])[0][0];
+                }
+                break;
+            case 1:
+                for (int i = 0; i < n; i++) {
+                    heap.fused(heap_points[i], rel, image);
+                    sum += image[0][0];
+                }
+                break;
+            case 2:
+                for (int i = 0; i < n; i++) {
+                    sum += cam.proj(points[i])[0][0];
+                }
+                break;
+            default:
+                cam.proj_points(points, images);
+                sum += images[n - 1][0][0];
+            }
+            bench_sink = bench_sink + sum;
+        };
+
+        times[path] = best_time(runs, project_all);
+        long long before = num_allocations.load();
+        project_all();
+        allocations[path] = num_allocations.load() - before;
+    }
+
+    printf("%d vertices, realnum is %d bytes\n", n, (int)sizeof(realnum));
+    printf("%-14s %18s %12s\n", "path", "allocs/vertex", "ns/vertex");
+    for (int path = 0; path < 4; path++) {
+        printf("%-14s %18.4f %12.1f\n", names[path], (double)allocations[path] / n, times[path] / n * 1e9);
+    }
+}
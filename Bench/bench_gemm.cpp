@@ -0,0 +1,73 @@
+#include "bench.h"
+#include "matrix.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+/*
+* The product as matrix::operator* computed it before blocking: for each entry,
+* a dot product walking down a column of B.
+*/
+static void naive_multiply(const matrix<double>& A, const matrix<double>& B, matrix<double>& out) {
+    int n = A.get_rows();
+    for (int j = 0; j < n; j++) {
+        for (int i = 0; i < n; i++) {
+            double sum = 0;
+            for (int k = 0; k < n; k++) {
+                sum += A[i][k] * B[k][j];
+            }
+            out.set(i, j, sum);
+        }
+    }
+}
+
+/*
+* GFLOP/s of square double products over sizes 4, 8, ... up to the largest, through
+* matrix::multiply (plain loop, blocked, or blocked across threads depending on the
+* size) and through the naive column-walking loop it replaced.  The naive loop is
+* only run up to 512, past which it takes minutes.
+*
+* Args: [largest size] (default 2048).
+*/
+void bench_gemm(const vector<string>& args) {
+    int largest = args.size() > 0 ? atoi(args[0].c_str()) : 2048;
+    const int naive_largest = 512;
+
+    printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    printf("%6s %12s %12s %9s\n", "n", "GFLOP/s", "naive", "speedup");
+    for (int n = 4; n <= largest; n *= 2) {
+        matrix<double> A(n, n), B(n, n), C(n, n);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                A.set(i, j, sin(i * 0.7 + j));
+                B.set(i, j, cos(i - j * 0.3));
+            }
+        }
+
+        //enough products per run to take a few milliseconds, and fewer runs of the slow sizes
+        double flops = 2.0 * n * n * n;
+        int reps = (int)std::max(1.0, 2e7 / flops);
+        int runs = flops > 1e9 ? 2 : 5;
+
+        double blocked = best_time(runs, [&]() {
+            for (int r = 0; r < reps; r++) {
+                matrix<double>::multiply(A, B, C);
+            }
+            bench_sink = bench_sink + C[n - 1][n - 1];
+        }) / reps;
+
+        if (n > naive_largest) {
+            printf("%6d %12.2f %12s %9s\n", n, flops / blocked * 1e-9, "-", "-");
+            continue;
+        }
+
+        double naive = best_time(runs, [&]() {
+            for (int r = 0; r < reps; r++) {
+                naive_multiply(A, B, C);
+            }
+            bench_sink = bench_sink + C[n - 1][n - 1];
+        }) / reps;
+
+        printf("%6d %12.2f %12.2f %8.1fx\n", n, flops / blocked * 1e-9, flops / naive * 1e-9, naive / blocked);
+    }
+}
@@ -0,0 +1,72 @@
+#include "bench.h"
+#include "matrixutils.h"
+#include <cstdio>
+#include <cstdlib>
+
+/*
+* Largest entry of |A B - I|.
+*/
+template<int N>
+static double residual(const fixed_matrix<realnum, N, N>& A, const fixed_matrix<realnum, N, N>& B) {
+    fixed_matrix<realnum, N, N> P = A * B;
+    double worst = 0;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            double e = fabs((double)P[i][j] - (i == j));
+            worst = e > worst ? e : worst;
+        }
+    }
+    return worst;
+}
+
+/*
+* 3x3 inverses per second through the closed form on fixed_matrix and through the
+* general path, an LU factorization of a matrix<realnum>, on the same inputs.  Also
+* prints the worst residual |A inv(A) - I| of each.
+*
+* Args: [number of matrices] (default 4096).
+*/
+void bench_inverse(const vector<string>& args) {
+    int n = args.size() > 0 ? atoi(args[0].c_str()) : 4096;
+    const int runs = 7;
+
+    //rotations times scalings, so every one is invertible and reasonably conditioned
+    vector<fixed_matrix<realnum, 3, 3>> fixed(n);
+    vector<matrix<realnum>> heap(n);
+    for (int i = 0; i < n; i++) {
+        fixed_matrix<realnum, 3, 3> S = fixed_matrix<realnum, 3, 3>::id();
+        S[0][0] = (realnum)(1 + i % 7);
+        S[1][1] = (realnum)(0.5 + i % 3);
+        S[2][2] = (realnum)(2 + sin(i));
+        fixed[i] = R3::rotate_intr(i * 0.1, i * 0.2, i * 0.3) * S;
+        heap[i] = fixed[i].dynamic();
+    }
+
+    vector<fixed_matrix<realnum, 3, 3>> fixed_out(n);
+    double closed_form = best_time(runs, [&]() {
+        for (int i = 0; i < n; i++) {
+            fixed_out[i] = inv(fixed[i]);
+        }
+        bench_sink = bench_sink + fixed_out[n - 1][0][0];
+    });
+
+    vector<matrix<realnum>> heap_out(n);
+    double lu = best_time(runs, [&]() {
+        for (int i = 0; i < n; i++) {
+            heap_out[i] = inv(heap[i]);
+        }
+        bench_sink = bench_sink + heap_out[n - 1][0][0];
+    });
+
+    double closed_form_residual = 0;
+    double lu_residual = 0;
+    for (int i = 0; i < n; i++) {
+        closed_form_residual = std::max(closed_form_residual, residual(fixed[i], fixed_out[i]));
+        lu_residual = std::max(lu_residual, residual(fixed[i], fixed_matrix<realnum, 3, 3>(heap_out[i])));
+    }
+
+    printf("%d matrices, realnum is %d bytes\n", n, (int)sizeof(realnum));
+    printf("%-12s %14s %10s %12s\n", "path", "inverses/s", "speedup", "residual");
+    printf("%-12s %13.2fM %9.1fx %12.2e\n", "closed form", n / closed_form * 1e-6, lu / closed_form, closed_form_residual);
+    printf("%-12s %13.2fM %9.1fx %12.2e\n", "LU", n / lu * 1e-6, 1.0, lu_residual);
+}
@@ -0,0 +1,220 @@
+#include "bench.h"
+#include "vertex_shader.h"
+#include "matrixutils.h"
+#include <cstdio>
+#include <cstdlib>
+
+template<typename F> const char* precision_name();
+template<> const char* precision_name<float>() { return "float"; }
+template<> const char* precision_name<double>() { return "double"; }
+template<> const char* precision_name<long double>() { return "long_double"; }
+
+/*
+* Nanoseconds per item of the inner kernels of the pipeline at scalar type F.
+*/
+struct precision_costs {
+    double transform;
+    double project;
+    double shade;
+    double inverse;
+};
+
+template<typename F>
+static precision_costs measure_costs(int n) {
+    typedef simd_vec::vec3<F> v3;
+    const int runs = 5;
+    precision_costs costs;
+
+    point_buffer<F> points(n);
+    for (int i = 0; i < n; i++) {
+        points.set(i, (F)sin(i * 0.1), (F)cos(i * 0.37), (F)(i % 100) + 10);
+    }
+    fixed_matrix<F, 3, 3> R = fixed_matrix<F, 3, 3>::id();
+    R[0][1] = (F)0.1;
+    R[1][2] = (F)-0.2;
+    fixed_matrix<F, 3, 4> T = affine_matrix(R, fixed_matrix<F, 3, 1>({ 1, -2, (F)0.5 }));
+    costs.transform = best_time(runs, [&]() {
+        transform_points(T, points.x(), points.y(), points.z(), n);
+        bench_sink = bench_sink + points.x()[n - 1];
+    }) / n * 1e9;
+
+    //a pinhole looking down z, with the last row giving depth
+    fixed_matrix<F, 3, 4> H = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 5 } };
+    vector<F> us(n), vs(n);
+    costs.project = best_time(runs, [&]() {
+        project_points(H, (F)400, fixed_matrix<F, 2, 1>(), fixed_matrix<F, 2, 1>(), points.x(), points.y(), points.z(),
+            us.data(), vs.data(), n);
+        bench_sink = bench_sink + us[n - 1];
+    }) / n * 1e9;
+
+    //what the smooth shader does per pixel: cast a ray onto the face and light it
+    v3 plane_x(1, (F)0.01, 0), plane_y(0, 1, (F)0.02), cam_pos(0, 0, -5), focal_point(0, 0, -6);
+    v3 face_pos(0, 0, 3), light_pos(3, 4, -2);
+    v3 normal = simd_vec::unitize(v3((F)0.1, (F)0.2, -1));
+    int width = 400;
+    int height = n / width + 1;
+    costs.shade = best_time(runs, [&]() {
+        double sum = 0;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                v3 pixel = plane_x * (F)x + plane_y * (F)y + cam_pos;
+                v3 dir = pixel - focal_point;
+                v3 hit = pixel + dir * (simd_vec::dot(face_pos - pixel, normal) / simd_vec::dot(dir, normal));
+                v3 ray = hit - light_pos;
+                F dist = simd_vec::norm(ray);
+                sum += simd_vec::dot(normal, ray * ((F)1 / dist)) / (1 + dist);
+            }
+        }
+        bench_sink = bench_sink + sum;
+    }) / ((double)width * height) * 1e9;
+
+    vector<fixed_matrix<F, 3, 3>> matrices(1024);
+    for (int i = 0; i < (int)matrices.size(); i++) {
+        matrices[i] = R;
+        matrices[i][0][0] = (F)(2 + i % 5);
+    }
+    costs.inverse = best_time(runs, [&]() {
+        F sum = 0;
+        for (const fixed_matrix<F, 3, 3>& A : matrices) {
+            sum += inv(A)[0][0];
+        }
+        bench_sink = bench_sink + sum;
+    }) / matrices.size() * 1e9;
+
+    return costs;
+}
+
+/*
+* The same scene through the whole pipeline in this build's realnum.
+*/
+static const int frame_width = 800;
+static const int frame_height = 600;
+
+static double render_scene(vector<u32>& pixels) {
+    pixels.assign(frame_width * frame_height, 0);
+    draw_device ddev(pixels.data(), frame_width, frame_height, 1);
+    camera cam(vec({ 0.5, 0.5, 0 }), vec({ -300, -300, 50 }));
+    cam.set_focus(400);
+    cam.rotate(0.1, 0.05);
+    cam.set_pos(vec({ -100, -100, 40 }));
+
+    cube box(60, { 0, 0, 0 });
+    box.set_pos({ 5, 5, 5 });
+    sphere ball(40, 20, { 10, 10, 10 });
+    light L1({ -60, -50, 20 }, 1000);
+    light L2({ 60, -50, 20 }, 1000);
+
+    vertex_shader shader(ddev, cam);
+    shader.add_light(&L1);
+    shader.add_light(&L2);
+    shader.add_mesh(&box.mesh);
+    shader.add_mesh(&ball.mesh);
+
+    //every frame draws over the last one, so the buffer ends up holding a single frame
+    return best_time(5, [&]() { shader.process_meshes(); });
+}
+
+static bool write_ppm(const char* path, const vector<u32>& pixels, int width, int height) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    vector<unsigned char> rgb(pixels.size() * 3);
+    for (size_t i = 0; i < pixels.size(); i++) {
+        rgb[3 * i] = (pixels[i] >> 16) & 0xFF;
+        rgb[3 * i + 1] = (pixels[i] >> 8) & 0xFF;
+        rgb[3 * i + 2] = pixels[i] & 0xFF;
+    }
+    bool ok = fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    return fclose(file) == 0 && ok;
+}
+
+static bool read_ppm(const char* path, vector<unsigned char>& rgb, int& width, int& height) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    int max_value = 0;
+    bool ok = fscanf(file, "P6 %d %d %d", &width, &height, &max_value) == 3 && max_value == 255 && fgetc(file) != EOF;
+    if (ok) {
+        rgb.resize((size_t)width * height * 3);
+        ok = fread(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    }
+    fclose(file);
+    return ok;
+}
+
+/*
+* How far apart two renders are: the share of pixels that differ at all, and the
+* largest and mean difference of a color channel (0-255) over the whole image.
+*/
+static void compare_images(const char* path_a, const char* path_b) {
+    vector<unsigned char> a, b;
+    int wa, ha, wb, hb;
+    if (!read_ppm(path_a, a, wa, ha) || !read_ppm(path_b, b, wb, hb)) {
+        printf("could not read %s or %s\n", path_a, path_b);
+        return;
+    }
+    if (wa != wb || ha != hb) {
+        printf("sizes differ: %dx%d against %dx%d\n", wa, ha, wb, hb);
+        return;
+    }
+
+    long long differing = 0;
+    long long total = 0;
+    int largest = 0;
+    for (size_t p = 0; p < a.size(); p += 3) {
+        bool differs = false;
+        for (int c = 0; c < 3; c++) {
+            int d = abs((int)a[p + c] - (int)b[p + c]);
+            total += d;
+            largest = d > largest ? d : largest;
+            differs = differs || d != 0;
+        }
+        differing += differs;
+    }
+
+    long long npixels = (long long)wa * ha;
+    printf("%s against %s, %dx%d\n", path_a, path_b, wa, ha);
+    printf("differing pixels %lld (%.3f%%), largest channel difference %d, mean %.4f\n",
+        differing, 100.0 * differing / npixels, largest, (double)total / (npixels * 3));
+}
+
+/*
+* What each precision costs and what it changes in the output.
+*
+* Prints the per-item cost of the pipeline's kernels at float, double and long
+* double, then renders a fixed scene through the whole pipeline at this build's
+* realnum (set with RENDERER_PRECISION) and writes it as a PPM.  Building once per
+* precision and passing two of the images back compares them.
+*
+* Args: [image path] (default frame_<realnum>.ppm), or two image paths to compare.
+*/
+void bench_precision(const vector<string>& args) {
+    if (args.size() >= 2) {
+        compare_images(args[0].c_str(), args[1].c_str());
+        return;
+    }
+
+    const int n = 1 << 16;
+    precision_costs costs[3] = { measure_costs<float>(n), measure_costs<double>(n), measure_costs<long double>(n) };
+    const char* names[3] = { precision_name<float>(), precision_name<double>(), precision_name<long double>() };
+
+    printf("ns per item, %d items\n", n);
+    printf("%-12s %10s %10s %10s %10s\n", "", "transform", "project", "shade", "3x3 inv");
+    for (int k = 0; k < 3; k++) {
+        printf("%-12s %10.2f %10.2f %10.2f %10.2f\n", names[k], costs[k].transform, costs[k].project, costs[k].shade, costs[k].inverse);
+    }
+
+    vector<u32> pixels;
+    double frame = render_scene(pixels);
+    string path = args.size() == 1 ? args[0] : string("frame_") + precision_name<realnum>() + ".ppm";
+    printf("\nwhole frame at realnum = %s: %.1f ms, %dx%d\n", precision_name<realnum>(), frame * 1e3, frame_width, frame_height);
+    if (write_ppm(path.c_str(), pixels, frame_width, frame_height)) {
+        printf("wrote %s\n", path.c_str());
+    }
+    else {
+        printf("could not write %s\n", path.c_str());
+    }
+}
@@ -0,0 +1,64 @@
+#include "bench.h"
+#include "linalg.h"
+#include <cstdio>
+#include <cstdlib>
+
+/*
+* Rigid transform v -> Rv + t of a cloud of points, done three ways:
+*   heap   - each point a matrix<realnum>, the way every vec was stored before
+*            fixed_matrix, so each product allocates its result
+*   fixed  - each point a fixed_matrix<realnum, 3, 1> on the stack
+*   batch  - all points in one point_buffer, through transform_points
+*
+* Args: [number of points] (default 100000).
+*/
+void bench_transform(const vector<string>& args) {
+    int n = args.size() > 0 ? atoi(args[0].c_str()) : 100000;
+    const int runs = 7;
+
+    fixed_matrix<realnum, 3, 3> R = R3::rotatez(0.3) * R3::rotatex(0.2);
+    fixed_matrix<realnum, 3, 1> t = { 1, -2, 0.5 };
+    matrix<realnum> R_heap = R.dynamic();
+    matrix<realnum> t_heap = t.dynamic();
+
+    vector<fixed_matrix<realnum, 3, 1>> points(n);
+    for (int i = 0; i < n; i++) {
+        points[i] = { (realnum)sin(i * 0.1), (realnum)cos(i * 0.37), (realnum)(i % 100) * (realnum)0.01 };
+    }
+
+    vector<matrix<realnum>> heap_points(n);
+    vector<matrix<realnum>> heap_out(n);
+    for (int i = 0; i < n; i++) {
+        heap_points[i] = points[i].dynamic();
+    }
+    double heap = best_time(runs, [&]() {
+        for (int i = 0; i < n; i++) {
+            heap_out[i] = R_heap * heap_points[i] + t_heap;
+        }
+        bench_sink = bench_sink + heap_out[n - 1][0][0];
+    });
+
+    vector<fixed_matrix<realnum, 3, 1>> fixed_out(n);
+    double fixed = best_time(runs, [&]() {
+        for (int i = 0; i < n; i++) {
+            fixed_out[i] = R * points[i] + t;
+        }
+        bench_sink = bench_sink + fixed_out[n - 1][0][0];
+    });
+
+    //transformed in place, so each run moves the points on by one more step
+    point_buffer<realnum> buffer(points);
+    fixed_matrix<realnum, 3, 4> T = affine_matrix(R, t);
+    double batch = best_time(runs, [&]() {
+        transform_points(T, buffer.x(), buffer.y(), buffer.z(), n);
+        bench_sink = bench_sink + buffer.x()[n - 1];
+    });
+
+    printf("%d points, realnum is %d bytes\n", n, (int)sizeof(realnum));
+    printf("%-8s %14s %10s\n", "path", "transforms/s", "vs heap");
+    const char* names[3] = { "heap", "fixed", "batch" };
+    double times[3] = { heap, fixed, batch };
+    for (int k = 0; k < 3; k++) {
+        printf("%-8s %13.1fM %9.1fx\n", names[k], n / times[k] * 1e-6, heap / times[k]);
+    }
+}
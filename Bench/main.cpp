@@ -0,0 +1,47 @@
+#include "bench.h"
+#include <cstdio>
+#include <cstring>
+
+volatile double bench_sink = 0;
+
+static const bench_case benches[] = {
+    { "transform", bench_transform, "transforms/s of heap matrix, fixed_matrix and batched points" },
+    { "alloc", bench_alloc, "heap allocations per projected vertex" },
+    { "gemm", bench_gemm, "GFLOP/s of square products, sizes 4 to 2048" },
+    { "inverse", bench_inverse, "3x3 inverses/s, closed form against LU" },
+    { "precision", bench_precision, "kernel costs per precision, renders frame_<realnum>.ppm; two .ppm args compare them" },
+};
+
+static const int num_benches = sizeof(benches) / sizeof(benches[0]);
+
+/*
+* Runs every benchmark, or only the one named by the first argument, in which case
+* the rest of the arguments go to it.
+*/
+int main(int argc, char** argv) {
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        printf("usage: Bench [name [args...]]\n");
+        for (int i = 0; i < num_benches; i++) {
+            printf("  %-12s %s\n", benches[i].name, benches[i].about);
+        }
+        return 0;
+    }
+
+    vector<string> args(argv + (argc > 1 ? 2 : 1), argv + argc);
+    int found = 0;
+    for (int i = 0; i < num_benches; i++) {
+        if (argc > 1 && strcmp(argv[1], benches[i].name) != 0) {
+            continue;
+        }
+        printf("== %s\n", benches[i].name);
+        benches[i].run(args);
+        printf("\n");
+        found++;
+    }
+
+    if (found == 0) {
+        fprintf(stderr, "no benchmark named %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+#pragma once
+#ifndef BATCH_TRANSFORM_H
+#define BATCH_TRANSFORM_H
+
+#include "fixed_matrix.h"
+#include "simd.h"
+#include <vector>
+
+using namespace std;
+
+/*
+* Points in R3 stored as structure of arrays: all x coordinates, then all y, then
+* all z.  Transforming the whole set reads and writes three contiguous streams,
+* which is what the batched kernels below vectorize over.
+*/
+template<typename F> class point_buffer
+{
+protected:
+	std::vector<F> xs;
+	std::vector<F> ys;
+	std::vector<F> zs;
+
+public:
+	//constructors
+	point_buffer();
+	point_buffer(int n);
+	point_buffer(const std::vector<fixed_matrix<F, 3, 1>>& points);
+
+	//operator overloads
+	inline fixed_matrix<F, 3, 1> operator [] (int i) const { return { xs[i], ys[i], zs[i] }; }
+
+	//get fields
+	int size() const { return (int)xs.size(); }
+	F* x() { return xs.data(); }
+	F* y() { return ys.data(); }
+	F* z() { return zs.data(); }
+	const F* x() const { return xs.data(); }
+	const F* y() const { return ys.data(); }
+	const F* z() const { return zs.data(); }
+
+	//shit
+	void set(int i, const fixed_matrix<F, 3, 1>& v) { xs[i] = v[0][0]; ys[i] = v[1][0]; zs[i] = v[2][0]; }
+	void set(int i, F x, F y, F z) { xs[i] = x; ys[i] = y; zs[i] = z; }
+	//keeps the capacity, so a buffer reused between frames stops allocating
+	void resize(int n) { xs.resize(n); ys.resize(n); zs.resize(n); }
+	void push_back(const fixed_matrix<F, 3, 1>& v);
+	std::vector<fixed_matrix<F, 3, 1>> points() const;
+};
+
+/*
+* One register's worth of scalars and the operations the kernels need.  The
+* general case is a single scalar, so every field type gets a working (if
+* unvectorized) kernel; float and double are specialized below for whatever
+* instruction set the build targets.
+*/
+template<typename F> struct simd_lane
+{
+	typedef F reg;
+	static const int width = 1;
+
+	static inline reg load(const F* p) { return *p; }
+	static inline void store(F* p, reg a) { *p = a; }
+	static inline reg set1(F c) { return c; }
+	static inline reg add(reg a, reg b) { return a + b; }
+	static inline reg sub(reg a, reg b) { return a - b; }
+	static inline reg mul(reg a, reg b) { return a * b; }
+	static inline reg div(reg a, reg b) { return a / b; }
+	//b where w is zero, a elsewhere
+	static inline reg select_zero(reg w, reg a, reg b) { return w == (F)0 ? b : a; }
+	//masks: le_zero flags the lanes of a that are <= 0, select takes b in flagged lanes and a elsewhere
+	static inline reg le_zero(reg a) { return a <= (F)0 ? (F)1 : (F)0; }
+	static inline reg select(reg mask, reg a, reg b) { return mask != (F)0 ? b : a; }
+	static inline int mask_bits(reg mask) { return mask != (F)0; }
+};
+
+#if defined(RENDERER_AVX)
+template<> struct simd_lane<double>
+{
+	typedef __m256d reg;
+	static const int width = 4;
+
+	static inline reg load(const double* p) { return _mm256_loadu_pd(p); }
+	static inline void store(double* p, reg a) { _mm256_storeu_pd(p, a); }
+	static inline reg set1(double c) { return _mm256_set1_pd(c); }
+	static inline reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+	static inline reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+	static inline reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+	static inline reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+	static inline reg select_zero(reg w, reg a, reg b) { return _mm256_blendv_pd(a, b, _mm256_cmp_pd(w, _mm256_setzero_pd(), _CMP_EQ_OQ)); }
+	static inline reg le_zero(reg a) { return _mm256_cmp_pd(a, _mm256_setzero_pd(), _CMP_LE_OQ); }
+	static inline reg select(reg mask, reg a, reg b) { return _mm256_or_pd(_mm256_and_pd(mask, b), _mm256_andnot_pd(mask, a)); }
+	static inline int mask_bits(reg mask) { return _mm256_movemask_pd(mask); }
+};
+
+template<> struct simd_lane<float>
+{
+	typedef __m256 reg;
+	static const int width = 8;
+
+	static inline reg load(const float* p) { return _mm256_loadu_ps(p); }
+	static inline void store(float* p, reg a) { _mm256_storeu_ps(p, a); }
+	static inline reg set1(float c) { return _mm256_set1_ps(c); }
+	static inline reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+	static inline reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+	static inline reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+	static inline reg div(reg a, reg b) { return _mm256_div_ps(a, b); }
+	static inline reg select_zero(reg w, reg a, reg b) { return _mm256_blendv_ps(a, b, _mm256_cmp_ps(w, _mm256_setzero_ps(), _CMP_EQ_OQ)); }
+	static inline reg le_zero(reg a) { return _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_LE_OQ); }
+	static inline reg select(reg mask, reg a, reg b) { return _mm256_or_ps(_mm256_and_ps(mask, b), _mm256_andnot_ps(mask, a)); }
+	static inline int mask_bits(reg mask) { return _mm256_movemask_ps(mask); }
+};
+#elif defined(RENDERER_SSE2)
+template<> struct simd_lane<double>
+{
+	typedef __m128d reg;
+	static const int width = 2;
+
+	static inline reg load(const double* p) { return _mm_loadu_pd(p); }
+	static inline void store(double* p, reg a) { _mm_storeu_pd(p, a); }
+	static inline reg set1(double c) { return _mm_set1_pd(c); }
+	static inline reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+	static inline reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+	static inline reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+	static inline reg div(reg a, reg b) { return _mm_div_pd(a, b); }
+	static inline reg select_zero(reg w, reg a, reg b) { return select(_mm_cmpeq_pd(w, _mm_setzero_pd()), a, b); }
+	static inline reg le_zero(reg a) { return _mm_cmple_pd(a, _mm_setzero_pd()); }
+	static inline reg select(reg mask, reg a, reg b) { return _mm_or_pd(_mm_and_pd(mask, b), _mm_andnot_pd(mask, a)); }
+	static inline int mask_bits(reg mask) { return _mm_movemask_pd(mask); }
+};
+
+template<> struct simd_lane<float>
+{
+	typedef __m128 reg;
+	static const int width = 4;
+
+	static inline reg load(const float* p) { return _mm_loadu_ps(p); }
+	static inline void store(float* p, reg a) { _mm_storeu_ps(p, a); }
+	static inline reg set1(float c) { return _mm_set1_ps(c); }
+	static inline reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+	static inline reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+	static inline reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+	static inline reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+	static inline reg select_zero(reg w, reg a, reg b) { return select(_mm_cmpeq_ps(w, _mm_setzero_ps()), a, b); }
+	static inline reg le_zero(reg a) { return _mm_cmple_ps(a, _mm_setzero_ps()); }
+	static inline reg select(reg mask, reg a, reg b) { return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)); }
+	static inline int mask_bits(reg mask) { return _mm_movemask_ps(mask); }
+};
+#endif
+
+/*
+* Batched kernels over coordinate arrays of length n.  A 3x4 matrix [A | t] is the
+* affine map v -> Av + t.
+*/
+template<typename F>
+static fixed_matrix<F, 3, 4> affine_matrix(const fixed_matrix<F, 3, 3>& A, const fixed_matrix<F, 3, 1>& t = fixed_matrix<F, 3, 1>());
+template<typename F>
+static void translate_points(const fixed_matrix<F, 3, 1>& t, F* xs, F* ys, F* zs, int n);
+template<typename F>
+static void transform_points(const fixed_matrix<F, 3, 4>& T, F* xs, F* ys, F* zs, int n);
+template<typename F>
+static void project_points(const fixed_matrix<F, 3, 4>& H, F scale, const fixed_matrix<F, 2, 1>& offset,
+	const fixed_matrix<F, 2, 1>& fallback, const F* xs, const F* ys, const F* zs, F* us, F* vs, int n);
+template<typename F>
+static int clip_segments(const fixed_matrix<F, 3, 1>& plane_pos, const fixed_matrix<F, 3, 1>& plane_normal,
+	F* px, F* py, F* pz, F* qx, F* qy, F* qz, unsigned char* keep, int n);
+template<typename F>
+static int clip_segments(const fixed_matrix<F, 3, 1>& plane_pos, const fixed_matrix<F, 3, 1>& plane_normal,
+	point_buffer<F>& starts, point_buffer<F>& ends, unsigned char* keep);
+
+#include "batch_transform.hpp"
+
+#endif
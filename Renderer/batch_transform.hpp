@@ -0,0 +1,266 @@
+
+#ifndef BATCH_TRANSFORM_HPP
+#define BATCH_TRANSFORM_HPP
+
+#include "batch_transform.h"
+#include <algorithm>
+
+//POINT BUFFER
+
+template<typename F>
+point_buffer<F>::point_buffer() {
+}
+
+/*
+* Creates buffer of n points at the origin.
+*/
+template<typename F>
+point_buffer<F>::point_buffer(int n) : xs(n), ys(n), zs(n) {
+}
+
+/*
+* Splits a list of column vectors into coordinate arrays.
+*/
+template<typename F>
+point_buffer<F>::point_buffer(const std::vector<fixed_matrix<F, 3, 1>>& points) : xs(points.size()), ys(points.size()), zs(points.size()) {
+	for (int i = 0; i < (int)points.size(); i++) {
+		this->set(i, points[i]);
+	}
+}
+
+template<typename F>
+void point_buffer<F>::push_back(const fixed_matrix<F, 3, 1>& v) {
+	xs.push_back(v[0][0]);
+	ys.push_back(v[1][0]);
+	zs.push_back(v[2][0]);
+}
+
+/*
+* Returns the points as a list of column vectors.
+*/
+template<typename F>
+std::vector<fixed_matrix<F, 3, 1>> point_buffer<F>::points() const {
+	std::vector<fixed_matrix<F, 3, 1>> out(this->size());
+	for (int i = 0; i < this->size(); i++) {
+		out[i] = (*this)[i];
+	}
+	return out;
+}
+
+//KERNELS
+
+template<typename F>
+fixed_matrix<F, 3, 4> affine_matrix(const fixed_matrix<F, 3, 3>& A, const fixed_matrix<F, 3, 1>& t) {
+	fixed_matrix<F, 3, 4> T;
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			T[i][j] = A[i][j];
+		}
+		T[i][3] = t[i][0];
+	}
+	return T;
+}
+
+/*
+* Adds t to every point.
+*/
+template<typename F>
+void translate_points(const fixed_matrix<F, 3, 1>& t, F* xs, F* ys, F* zs, int n) {
+	typedef simd_lane<F> lane;
+	const int W = lane::width;
+
+	typename lane::reg tx = lane::set1(t[0][0]);
+	typename lane::reg ty = lane::set1(t[1][0]);
+	typename lane::reg tz = lane::set1(t[2][0]);
+
+	int i = 0;
+	for (; i + W <= n; i += W) {
+		lane::store(xs + i, lane::add(lane::load(xs + i), tx));
+		lane::store(ys + i, lane::add(lane::load(ys + i), ty));
+		lane::store(zs + i, lane::add(lane::load(zs + i), tz));
+	}
+	for (; i < n; i++) {
+		xs[i] += t[0][0];
+		ys[i] += t[1][0];
+		zs[i] += t[2][0];
+	}
+}
+
+/*
+* Replaces every point v by Av + t, where T = [A | t].
+*/
+template<typename F>
+void transform_points(const fixed_matrix<F, 3, 4>& T, F* xs, F* ys, F* zs, int n) {
+	typedef simd_lane<F> lane;
+	typedef typename lane::reg reg;
+	const int W = lane::width;
+
+	reg m[3][4];
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 4; c++) {
+			m[r][c] = lane::set1(T[r][c]);
+		}
+	}
+
+	int i = 0;
+	for (; i + W <= n; i += W) {
+		reg x = lane::load(xs + i);
+		reg y = lane::load(ys + i);
+		reg z = lane::load(zs + i);
+		reg out[3];
+		for (int r = 0; r < 3; r++) {
+			out[r] = lane::add(lane::add(lane::mul(m[r][0], x), lane::mul(m[r][1], y)), lane::add(lane::mul(m[r][2], z), m[r][3]));
+		}
+		lane::store(xs + i, out[0]);
+		lane::store(ys + i, out[1]);
+		lane::store(zs + i, out[2]);
+	}
+	for (; i < n; i++) {
+		F x = xs[i], y = ys[i], z = zs[i];
+		xs[i] = T[0][0] * x + T[0][1] * y + (T[0][2] * z + T[0][3]);
+		ys[i] = T[1][0] * x + T[1][1] * y + (T[1][2] * z + T[1][3]);
+		zs[i] = T[2][0] * x + T[2][1] * y + (T[2][2] * z + T[2][3]);
+	}
+}
+
+/*
+* Perspective projection of every point.  With (a, b, w) = H(x, y, z, 1), the image
+* is offset + scale * (a/w, b/w), or fallback where w is zero.
+*/
+template<typename F>
+void project_points(const fixed_matrix<F, 3, 4>& H, F scale, const fixed_matrix<F, 2, 1>& offset,
+	const fixed_matrix<F, 2, 1>& fallback, const F* xs, const F* ys, const F* zs, F* us, F* vs, int n)
+{
+	typedef simd_lane<F> lane;
+	typedef typename lane::reg reg;
+	const int W = lane::width;
+
+	reg m[3][4];
+	for (int r = 0; r < 3; r++) {
+		for (int c = 0; c < 4; c++) {
+			m[r][c] = lane::set1(H[r][c]);
+		}
+	}
+	reg s = lane::set1(scale);
+	reg o[2] = { lane::set1(offset[0][0]), lane::set1(offset[1][0]) };
+	reg f[2] = { lane::set1(fallback[0][0]), lane::set1(fallback[1][0]) };
+
+	int i = 0;
+	for (; i + W <= n; i += W) {
+		reg x = lane::load(xs + i);
+		reg y = lane::load(ys + i);
+		reg z = lane::load(zs + i);
+		reg h[3];
+		for (int r = 0; r < 3; r++) {
+			h[r] = lane::add(lane::add(lane::mul(m[r][0], x), lane::mul(m[r][1], y)), lane::add(lane::mul(m[r][2], z), m[r][3]));
+		}
+		reg k = lane::div(s, h[2]);
+		lane::store(us + i, lane::select_zero(h[2], lane::add(o[0], lane::mul(k, h[0])), f[0]));
+		lane::store(vs + i, lane::select_zero(h[2], lane::add(o[1], lane::mul(k, h[1])), f[1]));
+	}
+	for (; i < n; i++) {
+		F h[3];
+		for (int r = 0; r < 3; r++) {
+			h[r] = H[r][0] * xs[i] + H[r][1] * ys[i] + (H[r][2] * zs[i] + H[r][3]);
+		}
+		if (h[2] == (F)0) {
+			us[i] = fallback[0][0];
+			vs[i] = fallback[1][0];
+			continue;
+		}
+		F k = scale / h[2];
+		us[i] = offset[0][0] + k * h[0];
+		vs[i] = offset[1][0] + k * h[1];
+	}
+}
+
+/*
+* Clips the segments p -> q to the half space n.(v - c) > 0 of the plane through c
+* with normal n, in place: an endpoint on or behind the plane is moved to where the
+* segment crosses it.  keep[i] is 0 when both endpoints are behind, in which
+* case the endpoints of segment i are left unspecified.  Returns the number kept.
+*/
+template<typename F>
+int clip_segments(const fixed_matrix<F, 3, 1>& plane_pos, const fixed_matrix<F, 3, 1>& plane_normal,
+	F* px, F* py, F* pz, F* qx, F* qy, F* qz, unsigned char* keep, int n)
+{
+	typedef simd_lane<F> lane;
+	typedef typename lane::reg reg;
+	const int W = lane::width;
+
+	F* ps[3] = { px, py, pz };
+	F* qs[3] = { qx, qy, qz };
+	reg c[3];
+	reg nv[3];
+	for (int r = 0; r < 3; r++) {
+		c[r] = lane::set1(plane_pos[r][0]);
+		nv[r] = lane::set1(plane_normal[r][0]);
+	}
+
+	int kept = 0;
+	int i = 0;
+	for (; i + W <= n; i += W) {
+		reg p[3];
+		reg q[3];
+		reg dp = lane::set1(0);
+		reg dq = lane::set1(0);
+		for (int r = 0; r < 3; r++) {
+			p[r] = lane::load(ps[r] + i);
+			q[r] = lane::load(qs[r] + i);
+			dp = lane::add(dp, lane::mul(lane::sub(p[r], c[r]), nv[r]));
+			dq = lane::add(dq, lane::mul(lane::sub(q[r], c[r]), nv[r]));
+		}
+		reg p_behind = lane::le_zero(dp);
+		reg q_behind = lane::le_zero(dq);
+
+		//p + t(q - p) is on the plane
+		reg t = lane::div(dp, lane::sub(dp, dq));
+		for (int r = 0; r < 3; r++) {
+			reg cut = lane::add(p[r], lane::mul(lane::sub(q[r], p[r]), t));
+			lane::store(ps[r] + i, lane::select(p_behind, p[r], cut));
+			lane::store(qs[r] + i, lane::select(q_behind, q[r], cut));
+		}
+
+		int dropped = lane::mask_bits(p_behind) & lane::mask_bits(q_behind);
+		for (int k = 0; k < W; k++) {
+			keep[i + k] = !((dropped >> k) & 1);
+			kept += keep[i + k];
+		}
+	}
+	for (; i < n; i++) {
+		F dp = 0;
+		F dq = 0;
+		for (int r = 0; r < 3; r++) {
+			dp += (ps[r][i] - plane_pos[r][0]) * plane_normal[r][0];
+			dq += (qs[r][i] - plane_pos[r][0]) * plane_normal[r][0];
+		}
+		bool p_behind = dp <= (F)0;
+		bool q_behind = dq <= (F)0;
+
+		keep[i] = !(p_behind && q_behind);
+		kept += keep[i];
+		if (!keep[i] || !(p_behind || q_behind)) {
+			continue;
+		}
+
+		F t = dp / (dp - dq);
+		for (int r = 0; r < 3; r++) {
+			F cut = ps[r][i] + (qs[r][i] - ps[r][i]) * t;
+			(p_behind ? ps : qs)[r][i] = cut;
+		}
+	}
+	return kept;
+}
+
+/*
+* clip_segments over the segments starts[i] -> ends[i].
+*/
+template<typename F>
+int clip_segments(const fixed_matrix<F, 3, 1>& plane_pos, const fixed_matrix<F, 3, 1>& plane_normal,
+	point_buffer<F>& starts, point_buffer<F>& ends, unsigned char* keep)
+{
+	return clip_segments(plane_pos, plane_normal, starts.x(), starts.y(), starts.z(),
+		ends.x(), ends.y(), ends.z(), keep, std::min(starts.size(), ends.size()));
+}
+
+#endif
\ No newline at end of file
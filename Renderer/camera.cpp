@@ -1,55 +1,191 @@
 #include "camera.h"
 #include <iostream>
 #include <math.h>
+#include <cassert>
 
 camera::camera(vec normal, vec pos, realnum focal_dist)
 {
 	normal = R3::unitize(normal);
 	this->pos = pos;
-	this->normal = normal;
 	this->focal_point = pos - normal * focal_dist;
 	this->focal_dist = focal_dist;
 
-	this->cam_plane = hyperplane<R3>(normal);
+	set_frame(normal);
+}
+
+/*
+* Points the camera along (unit) normal, taking the plane basis from hyperplane<R3>.
+*/
+void camera::set_frame(vec normal) {
+	hyperplane<R3> plane(normal);
+	vec p1 = plane[0];
+	vec p2 = plane[1];
+
+	//(p1, p2, normal) has to be right handed to be a rotation
+	if (det(mat({ p1, p2, normal })) < 0) {
+		p1 = p1 * -1;
+	}
+
+	this->normal = normal;
+	this->orientation = quaternion<realnum>::from_matrix(mat({ p1, p2, normal }));
+	this->plane_proj = fixed_matrix<realnum, 3, 2>({ p1, p2 }).t();
+	this->view_proj_dirty = true;
+}
+
+/*
+* Reads normal and plane basis back off the orientation.
+*/
+void camera::update_frame() {
+	mat frame = this->orientation.to_matrix();
+	this->normal = frame.col(2);
+	this->plane_proj = fixed_matrix<realnum, 3, 2>({ frame.col(0), frame.col(1) }).t();
+	this->view_proj_dirty = true;
+}
+
+/*
+* With P the plane basis, s the focal distance and o = P(focal_point - pos), the image
+* of v is o + s P(v - focal_point) / n.(v - focal_point).  Writing the numerator over
+* the common denominator gives the rows of view_proj.
+*/
+void camera::update_view_proj() {
+	realnum scale = R3::ip(pos - focal_point, normal);
+	vec2 offset = plane_proj * (focal_point - pos);
+
+	fixed_matrix<realnum, 4, 4> M;
+	for (int j = 0; j < 3; j++) {
+		M[0][j] = plane_proj[0][j] * scale + normal[j][0] * offset[0][0];
+		M[1][j] = plane_proj[1][j] * scale + normal[j][0] * offset[1][0];
+		M[2][j] = 0;
+		M[3][j] = normal[j][0];
+	}
+	for (int i = 0; i < 4; i++) {
+		M[i][3] = -(M[i][0] * focal_point[0][0] + M[i][1] * focal_point[1][0] + M[i][2] * focal_point[2][0]);
+	}
+	M[2][3] = 1;
+
+	//with the focal point on the image plane every point projects to the same place,
+	//and there is nothing to invert
+	assert(this->focal_dist != 0);
+
+	this->view_proj = M;
+	this->view_proj_inv = inv(M);
+	//the closed form gives up on badly conditioned matrices that pivoting still inverts
+	if (this->view_proj_inv == fixed_matrix<realnum, 4, 4>::zero()) {
+		lu_decomposition<realnum> lu(M.dynamic());
+		assert(!lu.is_singular());
+		this->view_proj_inv = fixed_matrix<realnum, 4, 4>(lu.inverse());
+	}
+	this->proj_fallback = plane_proj * (pos * -1);
+
+	/*
+	* A point f + t n + u p0 + v p1 is in view when |u| <= (w/2) t / s and |v| <= (h/2) t / s,
+	* so the side planes have inward normals (w/2) n -+ s p0 and (h/2) n -+ s p1.
+	*/
+	vec p[2] = { plane_proj.row(0).t(), plane_proj.row(1).t() };
+	realnum half[2] = { view_width / 2, view_height / 2 };
+	auto set_plane = [&](int i, const vec& a, realnum d) {
+		realnum k = 1 / R3::norm(a);
+		for (int j = 0; j < 3; j++) {
+			this->view_frustum.planes[i][j][0] = a[j][0] * k;
+		}
+		this->view_frustum.planes[i][3][0] = d * k;
+	};
+	set_plane(frustum::near_plane, normal, -R3::ip(normal, focal_point + normal));
+	set_plane(frustum::far_plane, normal * -1, R3::ip(normal, focal_point) + far_dist);
+	for (int k = 0; k < 2; k++) {
+		for (int sgn = -1; sgn <= 1; sgn += 2) {
+			int i = frustum::left_plane + 2 * k + (sgn > 0);
+			//without a viewport the sides accept everything
+			if (half[k] <= 0) {
+				this->view_frustum.planes[i] = fixed_matrix<realnum, 4, 1>::zero();
+				continue;
+			}
+			vec a = normal * half[k] + p[k] * (scale * -sgn);
+			set_plane(i, a, -R3::ip(a, focal_point));
+		}
+	}
+
+	this->view_proj_dirty = false;
 }
 
 void camera::set_facing(vec normal) {
-	this->normal = R3::unitize(normal);
+	set_frame(R3::unitize(normal));
 	this->pos = focal_point + normal * focal_dist;
-	this->cam_plane = hyperplane<R3>(normal);
+	this->view_proj_dirty = true;
 }
 
 void camera::rotate(double horz, double vert) {
-	//planevert and planehorz are a basis for the plane subspace
-	vec planenorm = this->normal;
-	
 	/*
 	* rotates the normal vector and vertical part of the plane basis by angle
 	* 'vert' around the vector orthogonal to the normal vector and parallel to the
 	* xy plane. All vectors are then rotated clockwise with respect to the xy plane 
 	* by angle 'horz.'
 	*/
-	planenorm = R3::rotatex(-horz) * R3::rot_axis(this->cam_plane[0], vert) *planenorm;
+	vec planehorz = plane_proj.row(0).t();
+	quaternion<realnum> rotation =
+		quaternion<realnum>::axis_angle(vec::std_basis(2), horz) * quaternion<realnum>::axis_angle(planehorz, -vert);
 
-	this->normal = planenorm;
+	this->orientation = rotation * this->orientation;
+	this->orientation.normalize();
+	update_frame();
 
 	//this makes it so the focal point serves as the 'joint' for rotation
-	this->pos = focal_point + planenorm*focal_dist;
-	this->cam_plane = hyperplane<R3>(planenorm);
-
+	this->pos = focal_point + normal*focal_dist;
+	this->view_proj_dirty = true;
 }
 
 mat camera::cam_rotation(double horz, double vert)
 {
-	return R3::rotatex(-horz) * R3::rot_axis(this->cam_plane[0], vert);
+	return R3::rotatex(-horz) * R3::rot_axis(plane_proj.row(0).t(), vert);
 }
 
 void camera::set_focus(realnum focus) {
 	this->focal_dist = focus;
-	this->pos = focal_point + normal * focus;;
+	this->pos = focal_point + normal * focus;
+	this->view_proj_dirty = true;
 }
 
 void camera::set_pos(vec v){
 	this->pos = v + normal * focal_dist;
 	this->focal_point = v;
+	this->view_proj_dirty = true;
+}
+
+void camera::set_render_dist(realnum dist) {
+	this->far_dist = dist;
+	this->view_proj_dirty = true;
+}
+
+void camera::set_viewport(realnum width, realnum height) {
+	if (width != this->view_width || height != this->view_height) {
+		this->view_width = width;
+		this->view_height = height;
+		this->view_proj_dirty = true;
+	}
+}
+
+void camera::proj_points(const point_buffer<realnum>& points, realnum* us, realnum* vs) {
+	const fixed_matrix<realnum, 4, 4>& M = this->get_view_proj();
+
+	//rows (a, b, w) of view_proj
+	fixed_matrix<realnum, 3, 4> H;
+	for (int j = 0; j < 4; j++) {
+		H[0][j] = M[0][j];
+		H[1][j] = M[1][j];
+		H[2][j] = M[3][j];
+	}
+
+	project_points(H, (realnum)1, vec2::zero(), proj_fallback, points.x(), points.y(), points.z(), us, vs, points.size());
+}
+
+void camera::proj_points(const point_buffer<realnum>& points, vector<vec2>& out) {
+	int n = points.size();
+	vector<realnum> us(n), vs(n);
+	proj_points(points, us.data(), vs.data());
+
+	out.resize(n);
+	for (int i = 0; i < n; i++) {
+		out[i][0][0] = us[i];
+		out[i][1][0] = vs[i];
+	}
 }
@@ -2,9 +2,49 @@
 #include "linalg.h"
 
 using namespace linalg;
-using mat = matrix<R3::field>;
+using mat = fixed_matrix<R3::field, 3, 3>;
 using vec = R3::elem;
 
+/*
+* View volume of a camera as six planes (a, b, c, d), each bounding the half
+* space a x + b y + c z + d >= 0, with (a, b, c) a unit inward normal.  Left/right
+* and bottom/top bound the first and second image coordinate from below/above.
+*/
+struct frustum {
+	enum { near_plane, far_plane, left_plane, right_plane, bottom_plane, top_plane };
+
+	fixed_matrix<realnum, 4, 1> planes[6];
+
+	inline realnum dist(int i, const vec& v) const {
+		return planes[i][0][0] * v[0][0] + planes[i][1][0] * v[1][0] + planes[i][2][0] * v[2][0] + planes[i][3][0];
+	}
+
+	//false only if the sphere is entirely outside one of the planes
+	bool sees_sphere(const vec& center, realnum radius) const {
+		for (int i = 0; i < 6; i++) {
+			if (dist(i, center) < -radius) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//false only if the box is entirely outside one of the planes
+	bool sees_box(const vec& lo, const vec& hi) const {
+		for (int i = 0; i < 6; i++) {
+			//corner furthest along the plane normal
+			vec corner;
+			for (int k = 0; k < 3; k++) {
+				corner[k][0] = planes[i][k][0] >= 0 ? hi[k][0] : lo[k][0];
+			}
+			if (dist(i, corner) < 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
 class camera {
 
 private:
@@ -13,12 +53,35 @@ private:
 	vec focal_point;
 	realnum focal_dist;
 	realnum FOV = 90;
+	realnum far_dist = numeric_limits<realnum>::infinity();
 
-	hyperplane<R3> cam_plane;
+	//size of the visible part of the image plane
+	realnum view_width = 0;
+	realnum view_height = 0;
+
+	//rotation taking the standard basis to (plane basis, normal)
+	quaternion<realnum> orientation;
+	fixed_matrix<realnum, 2, 3> plane_proj;
+
+	/*
+	* Homogeneous view-projection matrix and its inverse.  For a point v, with
+	* (a, b, c, w) = view_proj * (v, 1), the image of v is (a/w, b/w) and c = 1 so
+	* that c/w is the reciprocal depth.  Rebuilt on first use after the camera moves.
+	*/
+	fixed_matrix<realnum, 4, 4> view_proj;
+	fixed_matrix<realnum, 4, 4> view_proj_inv;
+	//image of points level with the focal point, where w = 0
+	vec2 proj_fallback;
+	frustum view_frustum;
+	bool view_proj_dirty = true;
+
+	void set_frame(vec normal);
+	void update_frame();
+	void update_view_proj();
 public:
 	camera() { this->focal_dist = 0; }
 
-	camera( vec normal, vec pos = mat::zero(3, 1), realnum focal_dist = 1);
+	camera( vec normal, vec pos = vec::zero(), realnum focal_dist = 1);
 
 	void set_facing(vec normal); 
 
@@ -30,27 +93,85 @@ public:
 	mat cam_rotation(double horz, double vert);
 	void set_focus(realnum focus);
 	void set_pos(vec v);
+	void set_render_dist(realnum dist);
+
+	/*
+	* Visible part of the image plane, a width x height rectangle centered on the camera
+	* position, e.g. the extent of the draw_device it renders to.
+	*/
+	void set_viewport(realnum width, realnum height);
 
 	vec get_pos() { return  this->pos; }
 	vec get_focal_point() { return this->focal_point; }
 	vec get_normal() { return this->normal; }
 	realnum get_foc_dist() { return this->focal_dist; }
 
+	quaternion<realnum> get_orientation() { return this->orientation; }
+
 	hyperplane<R3> get_plane() {
-		return this->cam_plane;
+		return hyperplane<R3>(normal, { plane_proj.row(0).t(), plane_proj.row(1).t() });
+	}
+
+	fixed_matrix<realnum, 2, 3> R2_proj() {
+		return this->plane_proj;
+	}
+
+	const fixed_matrix<realnum, 4, 4>& get_view_proj() {
+		if (this->view_proj_dirty) {
+			update_view_proj();
+		}
+		return this->view_proj;
 	}
 
-	mat R2_proj() {
-		return this->cam_plane.map_lower_dim();
+	/*
+	* Frustum with apex at the focal point through the edges of the viewport, cut off
+	* by the near clipping plane one unit in front of the focal point and by the render
+	* distance.  Side planes are only meaningful once the viewport has been set.
+	*/
+	const frustum& get_frustum() {
+		if (this->view_proj_dirty) {
+			update_view_proj();
+		}
+		return this->view_frustum;
 	}
 
+	const fixed_matrix<realnum, 4, 4>& get_view_proj_inv() {
+		if (this->view_proj_dirty) {
+			update_view_proj();
+		}
+		return this->view_proj_inv;
+	}
 
 	/*
 	* Finds the intersection of the camera plane and the line from the focal point to v, then
 	* maps the point to R2 using the camera position as the origin.
 	*/
-	inline vec proj(vec v) {
-		return  cam_plane.map_lower_dim() * (R3::line_plane_intersect(focal_point, v - focal_point, pos, normal) - pos);
+	inline vec2 proj(const vec& v) {
+		const fixed_matrix<realnum, 4, 4>& M = this->get_view_proj();
+		realnum h[4];
+		for (int i = 0; i < 4; i++) {
+			h[i] = M[i][0] * v[0][0] + M[i][1] * v[1][0] + M[i][2] * v[2][0] + M[i][3];
+		}
+		if (h[3] == 0) {
+			return this->proj_fallback;
+		}
+		return vec2({ h[0] / h[3], h[1] / h[3] });
 	}
 
+	/*
+	* Inverse of proj: the point with image p at depth (distance along the normal)
+	* depth from the focal point.
+	*/
+	inline vec unproj(const vec2& p, realnum depth) {
+		fixed_matrix<realnum, 4, 1> v = this->get_view_proj_inv() * fixed_matrix<realnum, 4, 1>({ p[0][0] * depth, p[1][0] * depth, 1, depth });
+		return vec({ v[0][0], v[1][0], v[2][0] }) * (1 / v[3][0]);
+	}
+
+	/*
+	* proj applied to a whole buffer of points at once, writing the image of point i
+	* to (us[i], vs[i]).
+	*/
+	void proj_points(const point_buffer<realnum>& points, realnum* us, realnum* vs);
+	void proj_points(const point_buffer<realnum>& points, vector<vec2>& out);
+
 };	
\ No newline at end of file
@@ -155,7 +155,7 @@ public:
     draw_device();
     draw_device(uint32_t* pMem_in, int width, int height, realnum scale =1) ;
 
-    matrix<realnum> get_center();
+    vec2 get_center();
     realnum get_width() { return this->DISPLAY_WIDTH / scale; }
     realnum get_height() { return this->DISPLAY_HEIGHT / scale; }
     pt get_center_raw() { return this->DISPLAY_CENTER; }
@@ -174,8 +174,8 @@ public:
         u32 color = 0xFFFFFF); 
 
     void draw_line(
-        matrix<realnum> O,
-        matrix<realnum> P,
+        vec2 O,
+        vec2 P,
         u32 color = 0xFFFFFF
     );
 
@@ -186,9 +186,9 @@ public:
     );
 
     void draw_triangle(
-        matrix<realnum> A,
-        matrix<realnum> B,
-        matrix<realnum> C,
+        vec2 A,
+        vec2 B,
+        vec2 C,
         u32 color = 0xFFFFFF
     );
 
@@ -201,15 +201,15 @@ public:
 
     template<typename func>
     void draw_quadrilateral(
-        matrix<int> adjacency,
-        vector<matrix<realnum>> vertices,
+        const matrix<int>& adjacency,
+        vector<vec2> vertices,
         func s,
         u32 color = 0xFFFFFF
     );
 
     template<typename func>
     void draw_quadrilateral_raw(
-        matrix<int> adjacency,
+        const matrix<int>& adjacency,
         int npts,
         pt* pts,
         func s
@@ -222,7 +222,7 @@ public:
     );
 
     void draw_circ(
-        matrix<realnum> O,
+        vec2 O,
         realnum r,
         u32 color = 0xFFFFFF
     );
@@ -246,8 +246,8 @@ private:
 
 template<typename func>
 void draw_device::draw_quadrilateral(
-    matrix<int> adjacency,
-    vector<matrix<realnum>> vertices,
+    const matrix<int>& adjacency,
+    vector<vec2> vertices,
     func s,
     u32 color
 )
@@ -267,7 +267,7 @@ void draw_device::draw_quadrilateral(
 
 template<typename func>
 void draw_device::draw_quadrilateral_raw(
-    matrix<int> adjacency,
+    const matrix<int>& adjacency,
     int npts,
     pt* pts,
     func s
@@ -325,8 +325,13 @@ void draw_device::draw_quadrilateral_raw(
         pt P1 = L1.eval_by_y(h - L1.O.y);
         pt P2 = L2.eval_by_y(h - L2.O.y);
 
-        int x_i = min(P1.x, P2.x);
-        int x_f = max(P1.x, P2.x);
+        //outlines clipped to the near plane can reach far off screen, so only the
+        //part of the span on screen is shaded
+        int x_i = max(min(P1.x, P2.x), 0);
+        int x_f = min(max(P1.x, P2.x), DISPLAY_WIDTH);
+        if (h < 0 || h >= DISPLAY_HEIGHT) {
+            x_f = x_i;
+        }
 
         for (int k = x_i; k < x_f; k++) {
             pt pos = pt(k, h) - DISPLAY_CENTER;
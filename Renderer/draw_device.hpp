@@ -25,9 +25,9 @@ draw_device::draw_device(uint32_t* pMem_in, int width, int height,realnum scale)
     this->scale = scale;
 }
 
-matrix<realnum> draw_device::get_center()
+vec2 draw_device::get_center()
 {
-    matrix<realnum> fake_center( { (realnum)DISPLAY_CENTER.x / scale, (realnum)DISPLAY_CENTER.y / scale });
+    vec2 fake_center( { (realnum)DISPLAY_CENTER.x / scale, (realnum)DISPLAY_CENTER.y / scale });
     return fake_center;
 }
 
@@ -46,7 +46,7 @@ void draw_device::set_color(u32 color)
     }
 }
 
-void draw_device::draw_line(matrix<realnum> O, matrix<realnum> P, u32 color)
+void draw_device::draw_line(vec2 O, vec2 P, u32 color)
 {
 
     pt O2 = DISPLAY_CENTER + pt(O * scale); 
@@ -55,7 +55,7 @@ void draw_device::draw_line(matrix<realnum> O, matrix<realnum> P, u32 color)
     draw_line_raw(O2, P2, color);
 }
 
-void draw_device::draw_circ(matrix<realnum> O, realnum r, u32 color) {
+void draw_device::draw_circ(vec2 O, realnum r, u32 color) {
     int x_center = DISPLAY_CENTER.x + O[0][0]*scale; int y_center = DISPLAY_CENTER.y + O[1][0] * scale; r *= scale;
     draw_circ_raw(x_center, y_center, (int)r, color);
 }
@@ -73,7 +73,7 @@ inline void draw_device::draw_line_raw(pt O, pt P, u32 color)
     }
 }
 
-void draw_device::draw_triangle(matrix<realnum> A, matrix<realnum> B, matrix<realnum> C, u32 color)
+void draw_device::draw_triangle(vec2 A, vec2 B, vec2 C, u32 color)
 {
     pt A2 = DISPLAY_CENTER + pt(A * scale);
     pt B2 = DISPLAY_CENTER + pt(B * scale);
@@ -102,6 +102,10 @@ void draw_device::draw_triangle_raw(pt A, pt B, pt C, u32 color)
     line mid_top(points[2], points[1]);
 
     for (int y = 0; y < height; y++) {
+        //rows off screen
+        if (points[0].y + y < 0 || points[0].y + y >= DISPLAY_HEIGHT) {
+            continue;
+        }
         bool below = (points[0].y + y < points[1].y);
 
         pt P1, P2;
@@ -0,0 +1,71 @@
+#pragma once
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+#include "matrix.h"
+#include <vector>
+#include <string>
+#include <initializer_list>
+
+using namespace std;
+
+/*
+* Class representing an (MxN)-matrix whose size is known at compile time.
+* Entries are stored inline, so small vectors and transforms live on the stack
+* and never touch the heap.
+*/
+template<typename F, int M, int N> class fixed_matrix
+{
+protected:
+	F arr[M][N];
+
+public:
+	//constructors
+	constexpr fixed_matrix();
+	constexpr fixed_matrix(const initializer_list<F>& v);
+	constexpr fixed_matrix(const initializer_list<initializer_list<F>>& x);
+
+	fixed_matrix(const initializer_list<fixed_matrix<F, M, 1>>& col_list);
+	fixed_matrix(const std::vector<fixed_matrix<F, M, 1>>& col_list);
+	explicit fixed_matrix(const matrix<F>& A);
+
+	//operator overloads
+	constexpr fixed_matrix operator + (fixed_matrix const& other) const;
+	constexpr fixed_matrix operator - (fixed_matrix const& other) const;
+	constexpr fixed_matrix operator * (F const& c) const;
+	template<int P>
+	constexpr fixed_matrix<F, M, P> operator * (fixed_matrix<F, N, P> const& other) const;
+	constexpr fixed_matrix& operator += (fixed_matrix const& other);
+	constexpr fixed_matrix& operator -= (fixed_matrix const& other);
+	constexpr fixed_matrix& operator *= (F const& c);
+	constexpr fixed_matrix& operator *= (fixed_matrix<F, N, N> const& other);
+	constexpr F* operator [] (int const& index) { return arr[index]; }
+	constexpr const F* operator [] (int const& index) const { return arr[index]; }
+	bool operator == (fixed_matrix const& other) const;
+
+	//static functions
+	static constexpr fixed_matrix id();
+	static constexpr fixed_matrix zero();
+	static constexpr fixed_matrix unit(int x, int y);
+	static constexpr fixed_matrix std_basis(int j);
+	std::string print() const;
+
+	//get fields
+	static constexpr int get_rows() { return M; }
+	static constexpr int get_cols() { return N; }
+	F* data() { return &arr[0][0]; }
+	const F* data() const { return &arr[0][0]; }
+	matrix<F> dynamic() const;
+
+	//shit
+	void set(int i, int j, F val) { this->arr[i][j] = val; }
+	constexpr fixed_matrix comp(int i, int j = 0) const;
+	constexpr fixed_matrix<F, 1, N> row(int i) const;
+	constexpr fixed_matrix<F, M, 1> col(int j) const;
+	constexpr fixed_matrix<F, N, M> t() const;
+	constexpr fixed_matrix<F, M - 1, N - 1> submatrix(int m, int n) const;
+};
+
+#include "fixed_matrix.hpp"
+
+#endif
@@ -0,0 +1,372 @@
+
+#ifndef FIXED_MATRIX_HPP
+#define FIXED_MATRIX_HPP
+
+#include "fixed_matrix.h"
+#include <string>
+#include <assert.h>
+#include <cassert>
+#include <iostream>
+
+using namespace std;
+
+//CONSTRUCTORS
+
+/*
+* Default constructor. Creates zero matrix.
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N>::fixed_matrix() : arr{} {
+}
+
+/*
+* Initializes matrix as (Mx1) column vector from list.
+*
+* @param v F list
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N>::fixed_matrix(const initializer_list<F>& v) : arr{}
+{
+	static_assert(N == 1, "list of scalars only initializes a column vector");
+
+	int i = 0;
+	for (F x : v) {
+		if (i < M) {
+			this->arr[i][0] = x;
+		}
+		i++;
+	}
+}
+
+/*
+* Initializes matrix from list of rows.
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N>::fixed_matrix(const initializer_list<initializer_list<F>>& x) : arr{}
+{
+	int i = 0;
+	for (const initializer_list<F>& row : x) {
+		int j = 0;
+		for (F val : row) {
+			if (i < M && j < N) {
+				this->arr[i][j] = val;
+			}
+			j++;
+		}
+		i++;
+	}
+}
+
+/*
+* Initializes matrix from list of column vectors.  Places them side by side.
+*/
+template<typename F, int M, int N>
+fixed_matrix<F, M, N>::fixed_matrix(const initializer_list<fixed_matrix<F, M, 1>>& col_list) : arr{}
+{
+	assert(col_list.size() == N);
+
+	int j = 0;
+	for (const fixed_matrix<F, M, 1>& v : col_list) {
+		for (int i = 0; i < M; i++) {
+			this->arr[i][j] = v[i][0];
+		}
+		j++;
+	}
+}
+
+/*
+* Initializes matrix from std::vector of column vectors.  Places them side by side.
+*/
+template<typename F, int M, int N>
+fixed_matrix<F, M, N>::fixed_matrix(const std::vector<fixed_matrix<F, M, 1>>& col_list) : arr{}
+{
+	assert(col_list.size() == N);
+
+	for (int j = 0; j < N; j++) {
+		for (int i = 0; i < M; i++) {
+			this->arr[i][j] = col_list[j][i][0];
+		}
+	}
+}
+
+/*
+* Copies entries of a dynamically sized matrix.  Sizes must agree.
+*/
+template<typename F, int M, int N>
+fixed_matrix<F, M, N>::fixed_matrix(const matrix<F>& A) : arr{}
+{
+	assert(A.get_rows() == M && A.get_cols() == N);
+
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			this->arr[i][j] = A[i][j];
+		}
+	}
+}
+
+//OPERATORS
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N> fixed_matrix<F, M, N>::operator + (fixed_matrix const& other) const {
+	fixed_matrix temp;
+
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			temp.arr[i][j] = arr[i][j] + other.arr[i][j];
+		}
+	}
+	return temp;
+}
+
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N> fixed_matrix<F, M, N>::operator - (fixed_matrix const& other) const {
+	fixed_matrix temp;
+
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			temp.arr[i][j] = arr[i][j] - other.arr[i][j];
+		}
+	}
+	return temp;
+}
+
+/*
+* Multiplication operator for scalars.
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N> fixed_matrix<F, M, N>::operator * (F const& c) const {
+	fixed_matrix temp;
+
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			temp.arr[i][j] = arr[i][j] * c;
+		}
+	}
+	return temp;
+}
+
+/*
+* Multiplication operator for matrices.  Inner dimensions are checked at compile time.
+*/
+template<typename F, int M, int N>
+template<int P>
+constexpr fixed_matrix<F, M, P> fixed_matrix<F, M, N>::operator * (fixed_matrix<F, N, P> const& other) const {
+	fixed_matrix<F, M, P> temp;
+
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < P; j++) {
+			F sum = 0;
+			for (int k = 0; k < N; k++) {
+				sum += arr[i][k] * other[k][j];
+			}
+			temp[i][j] = sum;
+		}
+	}
+	return temp;
+}
+
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N>& fixed_matrix<F, M, N>::operator += (fixed_matrix const& other) {
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			arr[i][j] += other.arr[i][j];
+		}
+	}
+	return *this;
+}
+
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N>& fixed_matrix<F, M, N>::operator -= (fixed_matrix const& other) {
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			arr[i][j] -= other.arr[i][j];
+		}
+	}
+	return *this;
+}
+
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N>& fixed_matrix<F, M, N>::operator *= (F const& c) {
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			arr[i][j] *= c;
+		}
+	}
+	return *this;
+}
+
+/*
+* Right multiplies matrix by a square matrix in place.
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N>& fixed_matrix<F, M, N>::operator *= (fixed_matrix<F, N, N> const& other) {
+	*this = *this * other;
+	return *this;
+}
+
+template<typename F, int M, int N>
+bool fixed_matrix<F, M, N>::operator == (fixed_matrix const& other) const {
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			if (arr[i][j] != other.arr[i][j]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/*
+* Returns string representation of matrix
+*/
+template<typename F, int M, int N>
+string fixed_matrix<F, M, N>::print() const {
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			std::cout << arr[i][j] << ", ";
+		}
+		std::cout << "\n";
+	}
+	return "\n";
+}
+
+//STATIC FUNCTIONS
+
+/*
+* Returns identity matrix.
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N> fixed_matrix<F, M, N>::id() {
+	static_assert(M == N, "identity matrix must be square");
+
+	fixed_matrix mat;
+	for (int i = 0; i < M; i++) {
+		mat.arr[i][i] = 1;
+	}
+	return mat;
+}
+
+/*
+* Returns zero matrix.
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N> fixed_matrix<F, M, N>::zero() {
+	return fixed_matrix();
+}
+
+/*
+* Returns matrix with 1 in a single entry.
+*
+* @param x,y row and column index to have 1
+* @return (MxN)-matrix with 1 in (x,y)-entry and zeroes elsewhere
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N> fixed_matrix<F, M, N>::unit(int x, int y) {
+	fixed_matrix mat;
+	mat.arr[x][y] = 1;
+	return mat;
+}
+
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N> fixed_matrix<F, M, N>::std_basis(int j) {
+	static_assert(N == 1, "standard basis vectors are column vectors");
+	return unit(j, 0);
+}
+
+//GET FIELDS
+
+/*
+* Copies entries into a dynamically sized matrix.
+*/
+template<typename F, int M, int N>
+matrix<F> fixed_matrix<F, M, N>::dynamic() const {
+	matrix<F> mat(M, N);
+
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			mat[i][j] = arr[i][j];
+		}
+	}
+	return mat;
+}
+
+//SHIT
+
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, N> fixed_matrix<F, M, N>::comp(int i, int j) const {
+	return unit(i, j) * this->arr[i][j];
+}
+
+/*
+* Returns (1xN)-matrix of i-th row.
+*
+* @param i row index
+* @return ith row of matrix
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, 1, N> fixed_matrix<F, M, N>::row(int i) const {
+	fixed_matrix<F, 1, N> mat;
+	for (int j = 0; j < N; j++) {
+		mat[0][j] = arr[i][j];
+	}
+	return mat;
+}
+
+/*
+* Returns (Mx1)-matrix of j-th column.
+*
+* @param j column index
+* @return j-th column of matrix
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M, 1> fixed_matrix<F, M, N>::col(int j) const {
+	fixed_matrix<F, M, 1> mat;
+	for (int i = 0; i < M; i++) {
+		mat[i][0] = arr[i][j];
+	}
+	return mat;
+}
+
+/*
+* Returns transpose of matrix.  Switches row and column indices of entries
+*
+* @return transpose matrix
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, N, M> fixed_matrix<F, M, N>::t() const {
+	fixed_matrix<F, N, M> mat;
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < N; j++) {
+			mat[j][i] = arr[i][j];
+		}
+	}
+	return mat;
+}
+
+/*
+* Returns submatrix with m-th row and n-th column removed.
+*
+* @param m,n row and column indices
+* @return (M-1 x N-1)-matrix which is the original matrix
+*	with mth row and nth col removed
+*/
+template<typename F, int M, int N>
+constexpr fixed_matrix<F, M - 1, N - 1> fixed_matrix<F, M, N>::submatrix(int m, int n) const {
+	fixed_matrix<F, M - 1, N - 1> temp;
+
+	int x = 0;
+	for (int i = 0; i < M; i++) {
+		if (i != m) {
+			int y = 0;
+			for (int j = 0; j < N; j++) {
+				if (j != n) {
+					temp[x][y] = arr[i][j];
+					y++;
+				}
+			}
+			x++;
+		}
+	}
+	return temp;
+}
+
+#endif
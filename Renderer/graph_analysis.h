@@ -0,0 +1,104 @@
+#pragma once
+#ifndef GRAPH_ANALYSIS_H
+#define GRAPH_ANALYSIS_H
+
+#include "graph_snapshot.h"
+#include "sparse_matrix.h"
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <thread>
+
+/*
+* Undirected graph in compressed sparse row form, the input of the graph analysis
+* functions below: the neighbors of node i are col_idx[row_ptr[i]] through
+* col_idx[row_ptr[i + 1] - 1], and every edge is listed from both ends.
+*/
+class csr_graph
+{
+protected:
+	std::vector<int> row_ptr;
+	std::vector<int> col_idx;
+
+public:
+	//constructors
+	csr_graph() : row_ptr(1, 0) {}
+	csr_graph(std::vector<int> row_ptr, std::vector<int> col_idx);
+
+	//connectivity of a linked_node graph, node ids as in the snapshot
+	template<typename T>
+	explicit csr_graph(const graph_snapshot<T>& snapshot);
+
+	/*
+	* Graph of a symmetric adjacency matrix, e.g. wiremesh::adjacency_matrix.  Zero
+	* entries and the diagonal are left out.
+	*/
+	template<typename F>
+	explicit csr_graph(const sparse_matrix<F>& adjacency);
+
+	//get fields
+	int get_node_count() const { return (int)row_ptr.size() - 1; }
+	int get_edge_count() const { return (int)col_idx.size() / 2; }
+	int degree(int i) const { return row_ptr[i + 1] - row_ptr[i]; }
+	const int* neighbors(int i) const { return col_idx.data() + row_ptr[i]; }
+	inline bool adjacent(int i, int j) const;
+	const std::vector<int>& get_row_ptr() const { return row_ptr; }
+	const std::vector<int>& get_col_idx() const { return col_idx; }
+};
+
+/*
+* Vertices of one connected component in increasing order, and its edges as (i, j)
+* with i < j, in increasing order of i.
+*/
+struct graph_component {
+	std::vector<int> vertices;
+	std::vector<std::pair<int, int>> edges;
+};
+
+/*
+* All functions below take nthreads = 0 to pick the thread count from the size of
+* the graph; small graphs are done on the calling thread.
+*/
+namespace graph_analysis {
+	static const long long parallel_threshold = 1 << 16;
+
+	/*
+	* Connected components by union-find over the edges, split between threads.
+	* @param labels [out] - component of each node.  Components are numbered in the
+	* order of their lowest node.
+	* @returns - number of components.
+	*/
+	inline int connected_components(const csr_graph& G, std::vector<int>& labels, int nthreads = 0);
+
+	/*
+	* Vertex and edge sets of each component, from labels and count as returned by
+	* connected_components.
+	*/
+	inline std::vector<graph_component> component_sets(const csr_graph& G, const std::vector<int>& labels, int count);
+
+	/*
+	* Level synchronous breadth first search: each level's frontier is divided
+	* between threads, which claim unvisited neighbors for the next one.
+	* @param levels [out] - distance in edges from source, -1 where unreachable.
+	* @returns - number of levels, i.e. one more than the largest distance.
+	*/
+	inline int bfs_levels(const csr_graph& G, int source, std::vector<int>& levels, int nthreads = 0);
+
+	//number of nodes of each degree, indexed by degree
+	inline std::vector<long long> degree_histogram(const csr_graph& G, int nthreads = 0);
+
+	/*
+	* Cycles of the given length without chords, i.e. sets of nodes each joined to
+	* exactly two others in the set: triangles for length 3, the faces of a quad mesh
+	* for length 4.  Found by extending paths out of each node through nodes higher
+	* than it, which takes O(E d^(length - 2)) for maximum degree d.
+	* @param cycles [out] - the cycles one after another, each in order around the
+	* cycle starting from its lowest node.
+	* @returns - number of cycles.
+	*/
+	inline int chordless_cycles(const csr_graph& G, int length, std::vector<int>& cycles, int nthreads = 0);
+}
+
+#include "graph_analysis.hpp"
+
+#endif
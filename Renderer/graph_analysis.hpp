@@ -0,0 +1,362 @@
+#ifndef GRAPH_ANALYSIS_HPP
+#define GRAPH_ANALYSIS_HPP
+
+#include "graph_analysis.h"
+#include <algorithm>
+#include <memory>
+
+//CONSTRUCTORS
+
+inline csr_graph::csr_graph(std::vector<int> row_ptr, std::vector<int> col_idx) {
+	this->row_ptr = std::move(row_ptr);
+	this->col_idx = std::move(col_idx);
+}
+
+template<typename T>
+csr_graph::csr_graph(const graph_snapshot<T>& snapshot) {
+	this->row_ptr = snapshot.get_row_ptr();
+	this->col_idx = snapshot.get_col_idx();
+}
+
+template<typename F>
+csr_graph::csr_graph(const sparse_matrix<F>& adjacency) : row_ptr(1, 0) {
+	int n = adjacency.get_rows();
+	this->row_ptr.reserve(n + 1);
+	this->col_idx.reserve(adjacency.get_nnz());
+	for (int i = 0; i < n; i++) {
+		const int* cols = adjacency.row_cols(i);
+		const F* vals = adjacency.row_vals(i);
+		for (int k = 0; k < adjacency.row_size(i); k++) {
+			if (cols[k] != i && vals[k] != 0) {
+				this->col_idx.push_back(cols[k]);
+			}
+		}
+		this->row_ptr.push_back((int)this->col_idx.size());
+	}
+}
+
+//SHIT
+
+//scans the shorter of the two neighbor lists
+inline bool csr_graph::adjacent(int i, int j) const {
+	if (this->degree(j) < this->degree(i)) {
+		std::swap(i, j);
+	}
+	const int* adj = this->neighbors(i);
+	return std::find(adj, adj + this->degree(i), j) != adj + this->degree(i);
+}
+
+namespace graph_analysis {
+
+	//threads to use for a pass over work edges when nthreads threads were asked for
+	inline int thread_count(long long work, int nthreads) {
+		if (nthreads > 0) {
+			return nthreads;
+		}
+		if (work < parallel_threshold) {
+			return 1;
+		}
+		return std::max(1, (int)std::thread::hardware_concurrency());
+	}
+
+	/*
+	* Calls f(t, i_begin, i_end) for nthreads blocks of consecutive nodes holding about
+	* the same number of edges each, block t on its own thread.
+	*/
+	template<typename func>
+	static void for_node_blocks(const csr_graph& G, int nthreads, func f) {
+		int n = G.get_node_count();
+		if (nthreads == 1) {
+			f(0, 0, n);
+			return;
+		}
+
+		const std::vector<int>& row_ptr = G.get_row_ptr();
+		long long total = (long long)row_ptr[n] + n;
+		std::vector<int> bounds(nthreads + 1, n);
+		bounds[0] = 0;
+		int i = 0;
+		for (int t = 1; t < nthreads; t++) {
+			//nodes count as work too, so isolated nodes still get spread out
+			long long target = total * t / nthreads;
+			while (i < n && (long long)row_ptr[i] + i < target) {
+				i++;
+			}
+			bounds[t] = i;
+		}
+
+		std::vector<std::thread> workers;
+		for (int t = 0; t < nthreads; t++) {
+			workers.push_back(std::thread(f, t, bounds[t], bounds[t + 1]));
+		}
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+	/*
+	* Root of i in a union-find forest, halving the path on the way up.  Only roots are
+	* ever relinked, and a non-root only ever gets pointed further up its own tree, so
+	* threads may do this concurrently.
+	*/
+	inline int find_root(std::atomic<int>* parent, int i) {
+		int p = parent[i].load(std::memory_order_relaxed);
+		while (p != i) {
+			int grandparent = parent[p].load(std::memory_order_relaxed);
+			parent[i].store(grandparent, std::memory_order_relaxed);
+			i = p;
+			p = grandparent;
+		}
+		return i;
+	}
+
+	/*
+	* Joins the trees of a and b by pointing the larger root at the smaller one, so the
+	* root of a tree is always its lowest node.  The link is a compare and swap on the
+	* root, retried if another thread relinked it first.
+	*/
+	inline void unite(std::atomic<int>* parent, int a, int b) {
+		while (true) {
+			a = find_root(parent, a);
+			b = find_root(parent, b);
+			if (a == b) {
+				return;
+			}
+			if (a < b) {
+				std::swap(a, b);
+			}
+			int expected = a;
+			if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) {
+				return;
+			}
+		}
+	}
+
+	inline int connected_components(const csr_graph& G, std::vector<int>& labels, int nthreads) {
+		int n = G.get_node_count();
+		nthreads = thread_count(G.get_edge_count(), nthreads);
+
+		std::unique_ptr<std::atomic<int>[]> parent(new std::atomic<int>[n]);
+		for (int i = 0; i < n; i++) {
+			parent[i].store(i, std::memory_order_relaxed);
+		}
+
+		//each edge once, from its lower end
+		for_node_blocks(G, nthreads, [&](int, int i_begin, int i_end) {
+			for (int i = i_begin; i < i_end; i++) {
+				const int* adj = G.neighbors(i);
+				for (int k = 0; k < G.degree(i); k++) {
+					if (adj[k] > i) {
+						unite(parent.get(), i, adj[k]);
+					}
+				}
+			}
+		});
+
+		//roots are the lowest node of their tree, so they get relabeled first
+		labels.resize(n);
+		int count = 0;
+		for (int i = 0; i < n; i++) {
+			int root = find_root(parent.get(), i);
+			labels[i] = (root == i) ? count++ : labels[root];
+		}
+		return count;
+	}
+
+	inline std::vector<graph_component> component_sets(const csr_graph& G, const std::vector<int>& labels, int count) {
+		int n = G.get_node_count();
+		std::vector<graph_component> components(count);
+
+		std::vector<int> vertex_count(count, 0);
+		std::vector<int> edge_count(count, 0);
+		for (int i = 0; i < n; i++) {
+			vertex_count[labels[i]]++;
+			edge_count[labels[i]] += G.degree(i);
+		}
+		for (int c = 0; c < count; c++) {
+			components[c].vertices.reserve(vertex_count[c]);
+			components[c].edges.reserve(edge_count[c] / 2);
+		}
+
+		for (int i = 0; i < n; i++) {
+			graph_component& component = components[labels[i]];
+			component.vertices.push_back(i);
+			const int* adj = G.neighbors(i);
+			for (int k = 0; k < G.degree(i); k++) {
+				if (adj[k] > i) {
+					component.edges.push_back(std::make_pair(i, adj[k]));
+				}
+			}
+		}
+		return components;
+	}
+
+	inline int bfs_levels(const csr_graph& G, int source, std::vector<int>& levels, int nthreads) {
+		int n = G.get_node_count();
+		nthreads = thread_count(G.get_edge_count(), nthreads);
+
+		std::unique_ptr<std::atomic<int>[]> level(new std::atomic<int>[n]);
+		for (int i = 0; i < n; i++) {
+			level[i].store(-1, std::memory_order_relaxed);
+		}
+		level[source].store(0, std::memory_order_relaxed);
+
+		std::vector<int> frontier(1, source);
+		std::vector<std::vector<int>> next(nthreads);
+		int depth = 0;
+
+		//claims the unvisited neighbors of frontier[f_begin, f_end) for level depth + 1
+		auto expand = [&](int t, int f_begin, int f_end) {
+			std::vector<int>& out = next[t];
+			for (int f = f_begin; f < f_end; f++) {
+				int i = frontier[f];
+				const int* adj = G.neighbors(i);
+				for (int k = 0; k < G.degree(i); k++) {
+					int expected = -1;
+					if (level[adj[k]].load(std::memory_order_relaxed) == -1 &&
+						level[adj[k]].compare_exchange_strong(expected, depth + 1, std::memory_order_relaxed)) {
+						out.push_back(adj[k]);
+					}
+				}
+			}
+		};
+
+		while (!frontier.empty()) {
+			long long work = 0;
+			for (int i : frontier) {
+				work += G.degree(i);
+			}
+
+			//narrow levels are not worth starting threads for
+			int level_threads = (work < parallel_threshold / 4) ? 1 : nthreads;
+			int f_count = (int)frontier.size();
+			if (level_threads == 1) {
+				expand(0, 0, f_count);
+			}
+			else {
+				std::vector<std::thread> workers;
+				int per_thread = (f_count + level_threads - 1) / level_threads;
+				for (int t = 0; t < level_threads; t++) {
+					int f_begin = std::min(f_count, t * per_thread);
+					int f_end = std::min(f_count, f_begin + per_thread);
+					workers.push_back(std::thread(expand, t, f_begin, f_end));
+				}
+				for (std::thread& worker : workers) {
+					worker.join();
+				}
+			}
+
+			frontier.clear();
+			for (int t = 0; t < level_threads; t++) {
+				frontier.insert(frontier.end(), next[t].begin(), next[t].end());
+				next[t].clear();
+			}
+			depth++;
+		}
+
+		levels.resize(n);
+		for (int i = 0; i < n; i++) {
+			levels[i] = level[i].load(std::memory_order_relaxed);
+		}
+		return depth;
+	}
+
+	inline std::vector<long long> degree_histogram(const csr_graph& G, int nthreads) {
+		int n = G.get_node_count();
+		nthreads = thread_count(n, nthreads);
+
+		int max_degree = 0;
+		for (int i = 0; i < n; i++) {
+			max_degree = std::max(max_degree, G.degree(i));
+		}
+
+		std::vector<std::vector<long long>> partial(nthreads, std::vector<long long>(max_degree + 1, 0));
+		for_node_blocks(G, nthreads, [&](int t, int i_begin, int i_end) {
+			std::vector<long long>& histogram = partial[t];
+			for (int i = i_begin; i < i_end; i++) {
+				histogram[G.degree(i)]++;
+			}
+		});
+
+		for (int t = 1; t < nthreads; t++) {
+			for (int d = 0; d <= max_degree; d++) {
+				partial[0][d] += partial[t][d];
+			}
+		}
+		return partial[0];
+	}
+
+	/*
+	* Tries each neighbor of path[depth - 1] as path[depth], keeping only paths whose
+	* nodes are all above path[0] and have no chords.  near_start[v] == path[0] marks
+	* the neighbors of path[0].
+	*/
+	inline void extend_cycle(const csr_graph& G, int length, int* path, int depth, const int* near_start, std::vector<int>& out) {
+		int start = path[0];
+		bool last = (depth == length - 1);
+		const int* adj = G.neighbors(path[depth - 1]);
+		for (int k = 0; k < G.degree(path[depth - 1]); k++) {
+			int v = adj[k];
+			if (v <= start) {
+				continue;
+			}
+
+			//only the second and last nodes touch the start, and each cycle is taken in
+			//the direction where the second node is the lower of the two
+			bool touches_start = (near_start[v] == start);
+			if (depth > 1 && touches_start != last) {
+				continue;
+			}
+			if (last && v < path[1]) {
+				continue;
+			}
+
+			bool chordless = true;
+			for (int i = 1; i < depth - 1 && chordless; i++) {
+				chordless = (v != path[i]) && !G.adjacent(v, path[i]);
+			}
+			if (!chordless) {
+				continue;
+			}
+
+			path[depth] = v;
+			if (last) {
+				out.insert(out.end(), path, path + length);
+			}
+			else {
+				extend_cycle(G, length, path, depth + 1, near_start, out);
+			}
+		}
+	}
+
+	inline int chordless_cycles(const csr_graph& G, int length, std::vector<int>& cycles, int nthreads) {
+		int n = G.get_node_count();
+		nthreads = thread_count(G.get_edge_count(), nthreads);
+		cycles.clear();
+		if (length < 3) {
+			return 0;
+		}
+
+		//blocks of start nodes are contiguous, so joining them in order is deterministic
+		std::vector<std::vector<int>> partial(nthreads);
+		for_node_blocks(G, nthreads, [&](int t, int i_begin, int i_end) {
+			std::vector<int> near_start(n, -1);
+			std::vector<int> path(length);
+			for (int i = i_begin; i < i_end; i++) {
+				const int* adj = G.neighbors(i);
+				for (int k = 0; k < G.degree(i); k++) {
+					near_start[adj[k]] = i;
+				}
+				path[0] = i;
+				extend_cycle(G, length, path.data(), 1, near_start.data(), partial[t]);
+			}
+		});
+
+		for (int t = 0; t < nthreads; t++) {
+			cycles.insert(cycles.end(), partial[t].begin(), partial[t].end());
+		}
+		return (int)cycles.size() / length;
+	}
+}
+
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+#include "linked_node.h"
+#include <vector>
+
+/*
+* Frozen copy of everything reachable from a linked_node<T>, in flat arrays: the
+* data of node i is data[i] and its neighbors are col_idx[row_ptr[i]] through
+* col_idx[row_ptr[i + 1] - 1] (compressed sparse row), in the order of the node's
+* connections.  Node ids are those of a breadth first traversal from the root, so
+* the root is node 0.  A snapshot of several roots numbers each connected piece
+* this way in turn, after the pieces before it.
+*/
+template<typename T> class graph_snapshot
+{
+protected:
+	std::vector<T> data;
+	std::vector<int> row_ptr;
+	std::vector<int> col_idx;
+
+public:
+	//constructors
+	graph_snapshot();
+	explicit graph_snapshot(linked_node<T>& root);
+	template<typename iter>
+	graph_snapshot(iter begin, iter end);
+
+	//operator overloads
+	inline T& operator [] (int i) { return data[i]; }
+	inline const T& operator [] (int i) const { return data[i]; }
+
+	//get fields
+	int get_node_count() const { return (int)data.size(); }
+	int get_edge_count() const { return (int)col_idx.size() / 2; }
+	int degree(int i) const { return row_ptr[i + 1] - row_ptr[i]; }
+	const int* neighbors(int i) const { return col_idx.data() + row_ptr[i]; }
+	const std::vector<T>& get_data() const { return data; }
+	const std::vector<int>& get_row_ptr() const { return row_ptr; }
+	const std::vector<int>& get_col_idx() const { return col_idx; }
+
+	//shit
+	void to_nodes(linked_node<T>*& pnodes, linked_node<T>*& pnodes_end) const;
+
+private:
+	void add_component(linked_node<T>& root, std::vector<linked_node<T>*>& nodes);
+};
+
+#include "graph_snapshot.hpp"
+
+#endif
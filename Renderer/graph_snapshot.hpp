@@ -0,0 +1,90 @@
+
+#ifndef GRAPH_SNAPSHOT_HPP
+#define GRAPH_SNAPSHOT_HPP
+
+#include "graph_snapshot.h"
+
+//CONSTRUCTORS
+
+template<typename T>
+graph_snapshot<T>::graph_snapshot() : row_ptr(1, 0) {
+}
+
+template<typename T>
+graph_snapshot<T>::graph_snapshot(linked_node<T>& root) : row_ptr(1, 0) {
+	std::vector<linked_node<T>*> nodes;
+	this->add_component(root, nodes);
+}
+
+/*
+* Snapshot of everything reachable from any node in [begin, end), e.g. all vertices
+* of a graph that falls apart into several pieces.
+*/
+template<typename T>
+template<typename iter>
+graph_snapshot<T>::graph_snapshot(iter begin, iter end) : row_ptr(1, 0) {
+	std::vector<linked_node<T>*> nodes;
+	//an epoch of its own, so every traversal below is numbered after it even with
+	//other threads traversing at the same time
+	unsigned long long first_epoch = linked_node<T>::last_epoch.fetch_add(1) + 1;
+	for (iter it = begin; it != end; ++it) {
+		linked_node<T>& root = *it;
+		//already reached from an earlier root
+		if (root.traversal_epoch >= first_epoch) {
+			continue;
+		}
+		this->add_component(root, nodes);
+	}
+}
+
+/*
+* Two linear passes: the traversal numbers the nodes and lays out data and row_ptr
+* from the node degrees, then each neighbor list is written out as ids.
+*/
+template<typename T>
+void graph_snapshot<T>::add_component(linked_node<T>& root, std::vector<linked_node<T>*>& nodes) {
+	int offset = (int)nodes.size();
+	root.traverse(
+		[&](linked_node<T>* n, int) {
+			nodes.push_back(n);
+			this->data.push_back(n->data);
+			this->row_ptr.push_back(this->row_ptr.back() + n->rank);
+		},
+		[](linked_node<T>*, linked_node<T>*, int, int) {});
+
+	//traversal ids restart at 0 for every component
+	this->col_idx.resize(this->row_ptr.back());
+	for (int i = offset; i < (int)nodes.size(); i++) {
+		int* out = this->col_idx.data() + this->row_ptr[i];
+		for (int k = 0; k < nodes[i]->rank; k++) {
+			out[k] = offset + nodes[i]->connections[k]->traversal_id;
+		}
+	}
+}
+
+//SHIT
+
+/*
+* Builds the graph back as linked nodes in a new array [pnodes, pnodes_end), with
+* node i of the snapshot at pnodes + i.
+*/
+template<typename T>
+void graph_snapshot<T>::to_nodes(linked_node<T>*& pnodes, linked_node<T>*& pnodes_end) const {
+	int n = this->get_node_count();
+	pnodes = new linked_node<T>[n];
+	pnodes_end = pnodes + n;
+
+	for (int i = 0; i < n; i++) {
+		linked_node<T>& node = pnodes[i];
+		node.data = this->data[i];
+		node.reserve(this->degree(i));
+
+		//neighbor lists are already unique and symmetric
+		const int* adj = this->neighbors(i);
+		for (int k = 0; k < this->degree(i); k++) {
+			node.push_connection(pnodes + adj[k]);
+		}
+	}
+}
+
+#endif
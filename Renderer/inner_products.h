@@ -1,5 +1,6 @@
 #pragma once
 #include "matrix.h"
+#include "fixed_matrix.h"
 /*Various inner products for different vector spaces.
 * 
 * If an inner product can have any extra parameters, make sure to store all the
@@ -11,19 +12,20 @@ namespace inner_products {
 
 	template<typename F,int dim>
 	class std_coord {
-		using mat = matrix<F>;
+		using vec = fixed_matrix<F, dim, 1>;
+		using mat = fixed_matrix<F, dim, dim>;
 
 	public:
-		typedef matrix<F> ex_input;
+		typedef mat ex_input;
 
 		inline std_coord() {
-			this->weight = matrix<F>::id(dim);
+			this->weight = mat::id();
 		}
 		std_coord(mat  weight) {
 			this->weight = weight;
 		}
 	
-		inline F operator () (mat  v, mat  w) const {	
+		inline F operator () (vec  v, vec  w) const {	
 			return (v.t() *  w)[0][0];
 		}
 
@@ -1,4 +1,7 @@
 #include "matrix.h"
+#include "fixed_matrix.h"
+#include "sparse_matrix.h"
+#include "batch_transform.h"
 #include "matrixutils.h"
 #include "subspace.h"
 #include "inner_products.h"
@@ -8,7 +11,9 @@
 
 namespace linalg {
 	using vec = R3::elem;
-	using mat = matrix<R3::field>;
+	using vec2 = fixed_matrix<R3::field, 2, 1>;
+	using mat = fixed_matrix<R3::field, 3, 3>;
+	using vec3 = simd_vec::vec3<R3::field>;
 }
 
 
@@ -7,37 +7,13 @@
 #include <iterator>
 #include <cstddef> 
 #include <vector>
-#include <unordered_set>
 #include <utility>
-#include <map>
 #include <stdint.h>
+#include <atomic>
 
 #define uptr uintptr_t
 
-/*
-* Structure for storing the values of two pointers in as size_t.  For the sole 
-* purpose of making hash code generation easier.
-*/
-struct ptr_pair {
-    size_t a;
-    size_t b;
-
-    ptr_pair() { a = NULL; b = NULL; }
-    ptr_pair(void* pa, void* pb) { a = (size_t)pa; b = (size_t)pb; }
-
-    constexpr bool operator == (const ptr_pair& other) const {
-        return ((a == other.a || a == other.b) && (b == other.a || b == other.b));
-    }
-
-};
-
-struct ptr_pair_hash {
-    std::size_t operator () (const ptr_pair& pair) const {
-        auto a = static_cast<unsigned long long> (pair.a);
-        auto b = static_cast<unsigned long long> (pair.b);
-        return std::hash<size_t>()(pair.a)^std::hash<size_t>()(pair.b);
-     }
-};
+template<typename T> class graph_snapshot;
 
 template<typename T>
 struct linked_node {
@@ -71,11 +47,19 @@ public:
         pointer m_ptr;
     };
 
+    //neighbors stored inside the node before spilling to the heap
+    static const int inline_rank = 4;
+
     //constructors
     linked_node();
     linked_node(T data);
+    linked_node(const linked_node<T>& other);
+    linked_node(linked_node<T>&& other);
+    ~linked_node();
 
     //operators
+    linked_node& operator = (const linked_node<T>& other);
+    linked_node& operator = (linked_node<T>&& other);
     bool operator == (const linked_node<T>& other);
 
     //iterator
@@ -87,12 +71,17 @@ public:
     int get_rank() { return this->rank; }
 
     //other
+    void reserve(int n);
     void add_node(linked_node<T>& other);
     void remove_node(linked_node<T>& other);
     void add_node_list(const std::initializer_list<linked_node<T>*>& nodes);
     void remove_node_list(const std::initializer_list<linked_node<T>*>& nodes);
 
     //useful things
+    enum traversal_order { breadth_first, depth_first };
+
+    template<typename node_func, typename edge_func>
+    int traverse(node_func on_node, edge_func on_edge, traversal_order order = breadth_first);
     int total_node_count();
     template<typename func>
     void execute_func(func f);
@@ -101,15 +90,30 @@ public:
     void copy_to(linked_node<T>*& pcopy,linked_node<T>*& pcopy_end);
 
 private:
-    template<typename func>
-    void execute_func_rec(std::unordered_set<ptr_pair, ptr_pair_hash>& links_trav, func f);
-    int rank = 0;
+    friend class graph_snapshot<T>;
+
+    void push_connection(linked_node<T>* other);
+    bool erase_connection(linked_node<T>* other);
 
-    linked_node<T>** connections = nullptr;   
+    /*
+    * Neighbor list, a small vector: the first inline_rank neighbors live in the
+    * node itself and the list moves to a heap buffer of doubling capacity after that.
+    */
+    int rank = 0;
+    int capacity = inline_rank;
+    linked_node<T>* inline_connections[inline_rank];
+    linked_node<T>** connections = inline_connections;
+
+    //id given by the traversal numbered traversal_epoch, see traverse
+    int traversal_id = -1;
+    unsigned long long traversal_epoch = 0;
+    //atomic so that threads traversing disjoint graphs never share an epoch
+    static std::atomic<unsigned long long> last_epoch;
 };
 
 
 #include "linked_node.hpp"
+#include "graph_snapshot.h"
 
 #endif // !LINKED_NODE_H
 
@@ -12,10 +12,70 @@ linked_node<T>::linked_node() {
 template<typename T>
 linked_node<T>::linked_node(T data) {
     this->data = data;
-    this->connections = nullptr;
+}
+
+/*
+* Copies the data and the neighbor list.  The neighbors are not told about the copy.
+*/
+template<typename T>
+linked_node<T>::linked_node(const linked_node<T>& other) {
+    *this = other;
+}
+
+template<typename T>
+linked_node<T>::linked_node(linked_node<T>&& other) {
+    *this = std::move(other);
+}
+
+template<typename T>
+linked_node<T>::~linked_node() {
+    if (this->connections != this->inline_connections) {
+        delete[] this->connections;
+    }
 }
 
 //OPERATORS
+template<typename T>
+linked_node<T>& linked_node<T>::operator = (const linked_node<T>& other) {
+    if (this == &other) {
+        return *this;
+    }
+    this->data = other.data;
+    this->rank = 0;
+    this->reserve(other.rank);
+    for (int i = 0; i < other.rank; i++) {
+        this->connections[i] = other.connections[i];
+    }
+    this->rank = other.rank;
+    return *this;
+}
+
+template<typename T>
+linked_node<T>& linked_node<T>::operator = (linked_node<T>&& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (other.connections == other.inline_connections) {
+        *this = static_cast<const linked_node<T>&>(other);
+        other.rank = 0;
+        return *this;
+    }
+
+    //take over the heap buffer
+    if (this->connections != this->inline_connections) {
+        delete[] this->connections;
+    }
+    this->data = std::move(other.data);
+    this->connections = other.connections;
+    this->rank = other.rank;
+    this->capacity = other.capacity;
+
+    other.connections = other.inline_connections;
+    other.rank = 0;
+    other.capacity = inline_rank;
+    return *this;
+}
+
 template<typename T>
 bool linked_node<T>::operator == (const linked_node<T>& other) {
     if (this->data != other.data) {
@@ -42,83 +102,80 @@ bool linked_node<T>::operator == (const linked_node<T>& other) {
 
 //OTHER
 
-//add and remove nodes
+/*
+* Makes room for n neighbors without further allocation.
+*/
 template<typename T>
-void linked_node<T>::add_node(linked_node<T>& other) {
-    linked_node<T>* pother = &other;
-    for (int i = 0; i < this->rank; i++) {
-        if (this->connections[i] == pother) {
-            return;
-        }
-    }
-    if (this == pother) {
+void linked_node<T>::reserve(int n) {
+    if (n <= this->capacity) {
         return;
     }
 
-    linked_node<T>** new_connections = new linked_node<T>*[this->rank + 1];
-    linked_node<T>** new_connections_other = new linked_node<T>*[pother->rank + 1];
-
+    linked_node<T>** new_connections = new linked_node<T>*[n];
     for (int i = 0; i < this->rank; i++) {
-        *(new_connections + i) = *(this->connections + i);
+        new_connections[i] = this->connections[i];
     }
-    for (int i = 0; i < pother->rank; i++) {
-        *(new_connections_other + i) = *(pother->connections + i);
+    if (this->connections != this->inline_connections) {
+        delete[] this->connections;
     }
 
-    delete[] this->connections;
-    delete[] pother->connections;
-
-    *(new_connections + this->rank) = pother;
-    *(new_connections_other + pother->rank) = this;
-
     this->connections = new_connections;
-    pother->connections = new_connections_other;
+    this->capacity = n;
+}
 
+template<typename T>
+void linked_node<T>::push_connection(linked_node<T>* other) {
+    if (this->rank == this->capacity) {
+        this->reserve(2 * this->capacity);
+    }
+    this->connections[this->rank] = other;
     this->rank++;
-    pother->rank++;
 }
 
+/*
+* Removes other from the neighbor list in place, keeping the order of the rest.
+* @return whether other was a neighbor.
+*/
 template<typename T>
-void linked_node<T>::remove_node(linked_node<T>& other) {
-    if (this->rank == 0 || other.rank == 0) {
-        return;
+bool linked_node<T>::erase_connection(linked_node<T>* other) {
+    for (int i = 0; i < this->rank; i++) {
+        if (this->connections[i] == other) {
+            for (int j = i + 1; j < this->rank; j++) {
+                this->connections[j - 1] = this->connections[j];
+            }
+            this->rank--;
+            return true;
+        }
     }
+    return false;
+}
 
+//add and remove nodes
+template<typename T>
+void linked_node<T>::add_node(linked_node<T>& other) {
     linked_node<T>* pother = &other;
-
-    linked_node<T>** new_connections = new linked_node<T>*[this->rank - 1];
-    linked_node<T>** new_connections_other = new linked_node<T>*[pother->rank - 1];
-
-    bool is_removed = 0;
-    for (int i = 0; i < this->rank; i++) {
-        linked_node<T>* p = *(this->connections + i);
-        if (!(p == pother)) {
-            *(new_connections + i - is_removed) = *(this->connections + i);
-        }
-        else {
-            is_removed = true;
-        }
+    if (this == pother) {
+        return;
     }
 
-    is_removed = 0;
-    for (int i = 0; i < pother->rank; i++) {
-        linked_node<T>* p = *(pother->connections + i);
-        if (!(p == this)) {
-            *(new_connections_other + i - is_removed) = *(pother->connections + i);
-        }
-        else {
-            is_removed = true;
+    //the link is in both lists, so only the shorter one has to be searched
+    linked_node<T>* shorter = this->rank <= pother->rank ? this : pother;
+    linked_node<T>* longer = shorter == this ? pother : this;
+    for (int i = 0; i < shorter->rank; i++) {
+        if (shorter->connections[i] == longer) {
+            return;
         }
     }
 
-    //delete[] this->connections;
-    //delete[] pother->connections;
-
-    this->connections = new_connections;
-    pother->connections = new_connections_other;
+    this->push_connection(pother);
+    pother->push_connection(this);
+}
 
-    this->rank--;
-    pother->rank--;
+template<typename T>
+void linked_node<T>::remove_node(linked_node<T>& other) {
+    if (this->erase_connection(&other)) {
+        other.erase_connection(this);
+    }
 }
 
 template<typename T>
@@ -135,48 +192,97 @@ void linked_node<T>::remove_node_list(const std::initializer_list<linked_node<T>
     }
 }
 
-/*
-* "Runs through" entire structure of nodes, and for every connection, calls a user
-* specified function which does something with the two nodes in that connection.
-* 
-* @param f - function which takes two arguments of type linked_node<T>*.  It 
-*            is perfectly valid to pass a function which takes more arguments,
-*            as long as those arguments have default values.
-*/
-template<typename T> template<typename func>
-inline void linked_node<T>::execute_func(func f) {
-    //links_trav keeps track of the connections which have already been run through,
-    //as to avoid calling f on a connection more than once.
-    std::unordered_set<ptr_pair, ptr_pair_hash> links_trav;
-    this->execute_func_rec(links_trav, f);
-}
+template<typename T>
+std::atomic<unsigned long long> linked_node<T>::last_epoch(0);
 
 /*
-* Recursive part of execute_func. 
+* Visits every node reachable from this one, without recursion.  Nodes get dense ids
+* 0, 1, ... in the order they are discovered, breadth first or depth first, and each
+* node remembers its id for the current traversal, so telling visited nodes apart
+* needs no hashing.  Runs in O(V + E).
+*
+* @param on_node - called as on_node(node, id) once per node, when it is discovered.
+* @param on_edge - called as on_edge(a, b, id_a, id_b) once per connection, with
+*                  id_a < id_b.
+* @return int - number of nodes reached.
+*
+* Traversals of the same nodes must not overlap, e.g. by traversing again from
+* inside a callback, and the callbacks must not change any connections.  Graphs
+* that share no nodes can be traversed on different threads at the same time.
 */
 template<typename T>
-template<typename func>
-inline void linked_node<T>::execute_func_rec(std::unordered_set<ptr_pair, ptr_pair_hash>& links_trav, func f) {
-    int rank = this->rank;
+template<typename node_func, typename edge_func>
+int linked_node<T>::traverse(node_func on_node, edge_func on_edge, traversal_order order) {
+    unsigned long long epoch = last_epoch.fetch_add(1) + 1;
+
+    //nodes by id.  Breadth first, this doubles as the queue.
+    std::vector<linked_node<T>*> nodes;
+
+    auto discover = [&](linked_node<T>* n) {
+        n->traversal_epoch = epoch;
+        n->traversal_id = (int)nodes.size();
+        nodes.push_back(n);
+        on_node(n, n->traversal_id);
+    };
 
-    //break condition
-    if (rank == 0) {
-        return;
+    //every connection is seen from both ends, it is reported from the lower id
+    auto scan = [&](linked_node<T>* a, linked_node<T>* b) {
+        bool is_new = b->traversal_epoch != epoch;
+        if (is_new) {
+            discover(b);
+        }
+        if (a->traversal_id < b->traversal_id) {
+            on_edge(a, b, a->traversal_id, b->traversal_id);
+        }
+        return is_new;
+    };
+
+    discover(this);
+
+    if (order == breadth_first) {
+        for (int head = 0; head < (int)nodes.size(); head++) {
+            linked_node<T>* a = nodes[head];
+            for (int k = 0; k < a->rank; k++) {
+                scan(a, a->connections[k]);
+            }
+        }
+        return (int)nodes.size();
     }
 
-    //go through connections. 
-    int i = 0;
-    for (linked_node<T>* other : *this) {
-        ptr_pair link(this, other);
+    //node and the next connection to look at
+    std::vector<std::pair<linked_node<T>*, int>> stack;
+    stack.push_back({ this, 0 });
+    while (!stack.empty()) {
+        linked_node<T>* a = stack.back().first;
+        int k = stack.back().second;
+        if (k == a->rank) {
+            stack.pop_back();
+            continue;
+        }
+        stack.back().second++;
 
-        if (links_trav.count(link) == 0) {
-            links_trav.insert(link);
-            f(this, other);
-            other->execute_func_rec(links_trav, f);
-            i++;
+        linked_node<T>* b = a->connections[k];
+        if (scan(a, b)) {
+            stack.push_back({ b, 0 });
         }
     }
-    return;
+    return (int)nodes.size();
+}
+
+/*
+* "Runs through" entire structure of nodes, and for every connection, calls a user
+* specified function which does something with the two nodes in that connection.
+* 
+* @param f - function which takes two arguments of type linked_node<T>*.  It 
+*            is perfectly valid to pass a function which takes more arguments,
+*            as long as those arguments have default values.
+*/
+template<typename T> template<typename func>
+inline void linked_node<T>::execute_func(func f) {
+    this->traverse(
+        [](linked_node<T>*, int) {},
+        [&f](linked_node<T>* a, linked_node<T>* b, int, int) { f(a, b); },
+        depth_first);
 }
 
 /*
@@ -185,28 +291,15 @@ inline void linked_node<T>::execute_func_rec(std::unordered_set<ptr_pair, ptr_pa
 */
 template<typename T>
 inline int linked_node<T>::total_node_count() {
-    std::unordered_set<uptr> node_counter;
-
-    auto get_node_count = [&node_counter](linked_node<T>* n1, linked_node<T>* n2) {
-        uptr a1 = reinterpret_cast<uptr>(n1);
-        uptr a2 = reinterpret_cast<uptr>(n2);
-        if (node_counter.count(a1) == 0) {
-            node_counter.insert(a1);
-        }
-        if (node_counter.count(a2) == 0) {
-            node_counter.insert(a2);
-        }
-    };
-    this->execute_func(get_node_count);
-    return node_counter.size();
+    return this->traverse([](linked_node<T>*, int) {}, [](linked_node<T>*, linked_node<T>*, int, int) {});
 }
 
 /*
 * Copies entire linked node strucuture to a linked_node<T> pointer.  The node object
 * from which "copy_to" is called is copied to pcopy, and each subsequent node in the
 * structure is then placed into the adjacent spot in memory, with the last node being 
-* copied into pcopy_end.  The order of the nodes in memory will depend on the path 
-* taken through the node structure.
+* copied into pcopy_end.  The order of the nodes in memory is breadth first from this
+* node.
 * 
 * @param pcopy - reference to pointer which serves as the "starting
 * point".
@@ -214,38 +307,7 @@ inline int linked_node<T>::total_node_count() {
 */
 template<typename T>
 inline void linked_node<T>::copy_to(linked_node<T>*& pcopy, linked_node<T>*& pcopy_end) {
-    //shit
-    std::map<uptr, int> node_data;
-    pcopy = new linked_node<T>[this->total_node_count()];
-
-    int i = 0;
-    auto get_node_data = [&](linked_node<T>* n1, linked_node<T>* n2) {
-
-        uptr a1 = reinterpret_cast<uptr>(n1);
-        uptr a2 = reinterpret_cast<uptr>(n2);
-
-        if (node_data.count(a1) == 0) {
-            node_data.insert(std::pair<uptr, int>(a1, i));
-            pcopy[i] = linked_node<T>(n1->data);
-            i++;
-        }
-
-        if (node_data.count(a2) == 0) {
-            node_data.insert(std::pair<uptr, int>(a2, i));
-            pcopy[i] = linked_node<T>(n2->data);
-            i++;
-        }
-
-        auto& a = pcopy[node_data.at(a1)];
-        auto& b = pcopy[node_data.at(a2)];
-        a.add_node(b);
-    };
-    
-    this->execute_func(get_node_data);
-
-    pcopy_end = pcopy + i;
-    return;
+    graph_snapshot<T>(*this).to_nodes(pcopy, pcopy_end);
 }
 
-
 #endif // !LINKED_NODE_HPP
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef LU_DECOMPOSITION_H
+#define LU_DECOMPOSITION_H
+
+#include "matrix.h"
+#include <vector>
+
+/*
+* LU factorization PA = LU of a square matrix with partial pivoting.  The
+* factorization is computed once, after which determinants, inverses and any
+* number of right hand sides cost O(n^2) each.
+*
+* L (unit diagonal, not stored) and U share a single matrix: L below the
+* diagonal, U on and above it.
+*/
+template<typename F> class lu_decomposition
+{
+public:
+	//constructors
+	lu_decomposition();
+	lu_decomposition(const matrix<F>& A);
+
+	F det() const;
+	matrix<F> solve(const matrix<F>& b) const;
+	matrix<F> solve_many(const matrix<F>& B) const;
+	matrix<F> inverse() const;
+
+	//get fields
+	int get_size() const { return size; }
+	bool is_singular() const { return singular; }
+	const matrix<F>& get_lu() const { return LU; }
+	const std::vector<int>& get_perm() const { return perm; }
+
+private:
+	matrix<F> LU;
+	std::vector<int> perm; //row i of LU is row perm[i] of A
+	int size;
+	int swaps;
+	bool singular;
+};
+
+#include "lu_decomposition.hpp"
+
+#endif
@@ -0,0 +1,175 @@
+
+#ifndef LU_DECOMPOSITION_HPP
+#define LU_DECOMPOSITION_HPP
+
+#include "lu_decomposition.h"
+#include <assert.h>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+//CONSTRUCTORS
+
+/*
+* Default constructor. Factorization of a matrix of size zero.
+*/
+template<typename F>
+lu_decomposition<F>::lu_decomposition() {
+	size = 0;
+	swaps = 0;
+	singular = true;
+}
+
+/*
+* Factors A by Gaussian elimination, always pivoting on the entry of largest
+* magnitude in the current column.  A pivot smaller than n * epsilon times the
+* largest entry of A marks the matrix as singular.
+*/
+template<typename F>
+lu_decomposition<F>::lu_decomposition(const matrix<F>& A) : LU(A) {
+	assert(A.get_rows() == A.get_cols());
+
+	size = A.get_rows();
+	swaps = 0;
+	singular = false;
+	perm = std::vector<int>(size);
+	for (int i = 0; i < size; i++) {
+		perm[i] = i;
+	}
+
+	F scale = 0;
+	for (int i = 0; i < size; i++) {
+		for (int j = 0; j < size; j++) {
+			scale = std::max(scale, (F)std::abs(LU[i][j]));
+		}
+	}
+	F tolerance = std::numeric_limits<F>::epsilon() * scale * size;
+
+	for (int k = 0; k < size; k++) {
+		//find pivot
+		int p = k;
+		for (int i = k + 1; i < size; i++) {
+			if (std::abs(LU[i][k]) > std::abs(LU[p][k])) {
+				p = i;
+			}
+		}
+
+		if (p != k) {
+			std::swap_ranges(LU[k], LU[k] + size, LU[p]);
+			std::swap(perm[k], perm[p]);
+			swaps++;
+		}
+
+		F pivot = LU[k][k];
+		if (std::abs(pivot) <= tolerance) {
+			singular = true;
+			continue;
+		}
+
+		//eliminate below pivot
+		const F* row_k = LU[k];
+		for (int i = k + 1; i < size; i++) {
+			F* row_i = LU[i];
+			F l = row_i[k] / pivot;
+			row_i[k] = l;
+			for (int j = k + 1; j < size; j++) {
+				row_i[j] -= l * row_k[j];
+			}
+		}
+	}
+}
+
+/*
+* Determinant, the signed product of the pivots.
+*/
+template<typename F>
+F lu_decomposition<F>::det() const {
+	if (singular) {
+		return (F)0;
+	}
+
+	F value = (swaps % 2) ? (F)-1 : (F)1;
+	for (int i = 0; i < size; i++) {
+		value *= LU[i][i];
+	}
+	return value;
+}
+
+/*
+* Solves Ax = b for a single (nx1) column b.
+*
+* @return x, or a matrix of size zero if A is singular
+*/
+template<typename F>
+matrix<F> lu_decomposition<F>::solve(const matrix<F>& b) const {
+	assert(b.get_cols() == 1);
+	return solve_many(b);
+}
+
+/*
+* Solves AX = B for every column of B at once.  Forward and back substitution run
+* a row of X at a time, so the inner loops stay on contiguous memory.
+*
+* @return X, or a matrix of size zero if A is singular
+*/
+template<typename F>
+matrix<F> lu_decomposition<F>::solve_many(const matrix<F>& B) const {
+	assert(B.get_rows() == size);
+
+	if (singular) {
+		return matrix<F>();
+	}
+
+	int cols = B.get_cols();
+	matrix<F> X(size, cols);
+
+	//Ly = Pb
+	for (int i = 0; i < size; i++) {
+		F* x_i = X[i];
+		const F* b_i = B[perm[i]];
+		for (int j = 0; j < cols; j++) {
+			x_i[j] = b_i[j];
+		}
+
+		const F* l_i = LU[i];
+		for (int k = 0; k < i; k++) {
+			F l = l_i[k];
+			const F* x_k = X[k];
+			for (int j = 0; j < cols; j++) {
+				x_i[j] -= l * x_k[j];
+			}
+		}
+	}
+
+	//Ux = y
+	for (int i = size - 1; i >= 0; i--) {
+		F* x_i = X[i];
+		const F* u_i = LU[i];
+		for (int k = i + 1; k < size; k++) {
+			F u = u_i[k];
+			const F* x_k = X[k];
+			for (int j = 0; j < cols; j++) {
+				x_i[j] -= u * x_k[j];
+			}
+		}
+
+		F pivot = u_i[i];
+		for (int j = 0; j < cols; j++) {
+			x_i[j] /= pivot;
+		}
+	}
+
+	return X;
+}
+
+/*
+* @return inverse of A, or a matrix of size zero if A is singular
+*/
+template<typename F>
+matrix<F> lu_decomposition<F>::inverse() const {
+	return solve_many(matrix<F>::id(size));
+}
+
+#endif
@@ -0,0 +1,131 @@
+#include "mapped_file.h"
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::mapped_file(mapped_file&& other) {
+    *this = std::move(other);
+}
+
+mapped_file& mapped_file::operator = (mapped_file&& other) {
+    if (this != &other) {
+        this->close();
+        std::swap(this->data, other.data);
+        std::swap(this->size, other.size);
+        std::swap(this->opened_empty, other.opened_empty);
+#ifdef _WIN32
+        std::swap(this->file_handle, other.file_handle);
+        std::swap(this->mapping_handle, other.mapping_handle);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool mapped_file::open(const char* path) {
+    this->close();
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file);
+        this->opened_empty = true;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    this->file_handle = file;
+    this->mapping_handle = mapping;
+    this->data = (const char*)view;
+    this->size = (size_t)file_size.QuadPart;
+    return true;
+}
+
+void mapped_file::close() {
+    if (this->data != nullptr) {
+        UnmapViewOfFile(this->data);
+        CloseHandle(this->mapping_handle);
+        CloseHandle(this->file_handle);
+    }
+    this->data = nullptr;
+    this->size = 0;
+    this->opened_empty = false;
+    this->file_handle = nullptr;
+    this->mapping_handle = nullptr;
+}
+
+#else
+
+bool mapped_file::open(const char* path) {
+    this->close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        ::close(fd);
+        this->opened_empty = true;
+        return true;
+    }
+
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    //the mapping keeps the file alive on its own
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+    this->data = (const char*)view;
+    this->size = (size_t)info.st_size;
+    return true;
+}
+
+void mapped_file::close() {
+    if (this->data != nullptr) {
+        munmap((void*)this->data, this->size);
+    }
+    this->data = nullptr;
+    this->size = 0;
+    this->opened_empty = false;
+}
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+#include <stddef.h>
+
+/*
+* Read only memory mapping of a whole file.  The contents are paged in by the OS
+* on first touch, so opening a large file costs nothing up front and parsing reads
+* straight out of the page cache.
+*/
+class mapped_file {
+public:
+    //constructors
+    mapped_file() {}
+    explicit mapped_file(const char* path) { this->open(path); }
+    mapped_file(const mapped_file& other) = delete;
+    mapped_file(mapped_file&& other);
+    ~mapped_file() { this->close(); }
+
+    //operators
+    mapped_file& operator = (const mapped_file& other) = delete;
+    mapped_file& operator = (mapped_file&& other);
+
+    //maps the file at path, replacing any previous mapping. false if it can't be read.
+    bool open(const char* path);
+    void close();
+
+    //get fields
+    bool is_open() const { return this->data != nullptr || this->opened_empty; }
+    const char* begin() const { return this->data; }
+    const char* end() const { return this->data + this->size; }
+    size_t get_size() const { return this->size; }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    //zero length files can't be mapped, but open fine
+    bool opened_empty = false;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+};
@@ -11,21 +11,84 @@
 using namespace std;
 
 /*
-* Class representing an (mxn)-matrix.
+* Non-owning (mxn)-window into the storage of a matrix.  Entry (i,j) lives at
+* base[row_index(i) * row_stride + col_index(j) * col_stride], so rows, columns
+* and blocks are plain strided views, while submatrices (one row and column
+* removed) and selections (index lists) remap indices instead of copying.
+*
+* A view is only valid as long as the matrix it was taken from.
 */
-template<typename F = double> class matrix
+template<typename F> class matrix_view
 {
 protected:
+	F* base;
 	int rows;
 	int cols;
-	std::vector<std::vector<F>> arr;
-	F bigness = 0;
+	int row_stride;
+	int col_stride;
+
+	//index remapping, unused when null / negative
+	const int* row_indices = nullptr;
+	const int* col_indices = nullptr;
+	int skip_row = -1;
+	int skip_col = -1;
+
+public:
+	//constructors
+	matrix_view(F* base, int rows, int cols, int row_stride, int col_stride = 1);
+	matrix_view(F* base, int rows, int cols, int row_stride, const int* row_indices, const int* col_indices);
+	matrix_view(F* base, int rows, int cols, int row_stride, int skip_row, int skip_col);
+
+	inline int row_index(int i) const { return row_indices ? row_indices[i] : i + (skip_row >= 0 && i >= skip_row); }
+	inline int col_index(int j) const { return col_indices ? col_indices[j] : j + (skip_col >= 0 && j >= skip_col); }
+
+	inline F& operator () (int i, int j) const { return base[row_index(i) * row_stride + col_index(j) * col_stride]; }
+
+	//get fields
+	int get_rows() const { return rows; }
+	int get_cols() const { return cols; }
+};
+
+template<typename F> class matrix;
+template<typename F, typename L, typename R> class matrix_product;
+
+/*
+* Base class of everything that can appear in a matrix expression.  Arithmetic
+* on expressions builds a tree of lightweight nodes instead of computing
+* anything; the whole tree is evaluated entry by entry in a single loop when it
+* is assigned to a matrix, so a + b*c - d allocates only the result.
+*
+* @tparam F - scalar field
+* @tparam E - type of derived expression
+*/
+template<typename F, typename E> class matrix_expr
+{
+public:
+	typedef F field;
+
+	inline const E& self() const { return static_cast<const E&>(*this); }
+};
+
+/*
+* Class representing an (mxn)-matrix.  Entries are stored row-major in a single
+* contiguous buffer, with row i starting at arr[i * stride].
+*/
+template<typename F = double> class matrix : public matrix_expr<F, matrix<F>>
+{
+protected:
+	int rows;
+	int cols;
+	int stride;
+	std::vector<F> arr;
 
 public:
 	//constructors
 	matrix<F>();
+	matrix<F>(int m, int n);
 	matrix<F>(const matrix& A);
+	matrix<F>(matrix&& A);
 	matrix<F>(const std::vector<std::vector<F>>& x);
+	matrix<F>(const matrix_view<F>& view);
 
 	matrix<F>(const initializer_list<F>& v);
 	matrix<F>(const vector<F>& v);
@@ -33,51 +96,182 @@ public:
 	matrix<F>(const std::initializer_list<matrix>& col_list);
 	matrix<F>(std::vector<matrix> col_list);
 
+	//evaluation of expressions
+	template<typename E>
+	matrix<F>(const matrix_expr<F, E>& expr);
+	template<typename L, typename R>
+	matrix<F>(const matrix_product<F, L, R>& expr);
+
 	//operator overloads
-	matrix operator += (matrix const& other) const;
- 	matrix operator + (matrix const& other) const;
-	matrix operator - (matrix const& other) const;
-	matrix operator * (matrix const& other) const;
-	matrix operator * (F const& c) const;
-	inline std::vector<F> operator [] (int const& index) { return arr[index]; }
-	bool operator == (matrix const& other);
+	matrix& operator = (const matrix& other);
+	matrix& operator = (matrix&& other);
+	template<typename E>
+	matrix& operator = (const matrix_expr<F, E>& expr);
+	template<typename L, typename R>
+	matrix& operator = (const matrix_product<F, L, R>& expr);
+	template<typename E>
+	matrix& operator += (const matrix_expr<F, E>& expr);
+	template<typename E>
+	matrix& operator -= (const matrix_expr<F, E>& expr);
+	matrix& operator *= (F const& c);
+	template<typename E>
+	matrix& operator *= (const matrix_expr<F, E>& expr);
+
+	//an expiring left operand is reused as the result
+	template<typename E>
+	matrix operator + (const matrix_expr<F, E>& expr) &&;
+	template<typename E>
+	matrix operator - (const matrix_expr<F, E>& expr) &&;
+	matrix operator * (F const& c) &&;
+	inline F* operator [] (int const& index) { return arr.data() + index * stride; }
+	inline const F* operator [] (int const& index) const { return arr.data() + index * stride; }
+	inline F operator () (int i, int j) const { return arr[i * stride + j]; }
+	bool operator == (matrix const& other) const;
+
+	//entries can be computed independently of one another, so no temporaries are needed
+	static const bool elementwise = true;
+
+	//products with fewer multiply-adds than these use the plain loop / a single thread
+	static const long long blocked_threshold = 32 * 32 * 32;
+	static const long long parallel_threshold = 128 * 128 * 128;
+	static const int block_rows = 64;
+	static const int block_cols = 256;
 
 	//static functions
 	static matrix id(int n);
 	static matrix zero(int m, int n);
 	static matrix unit(int m, int n, int x, int y);
 	static matrix std_basis(int dim, int j);
+	static void multiply(const matrix& A, const matrix& B, matrix& out);
 	std::string print();
 
 	//get fields
-	int get_rows() { return rows; }
-	int get_cols() { return cols; }
-	std::vector<std::vector<F>> get_arr() { return arr; }
+	int get_rows() const { return rows; }
+	int get_cols() const { return cols; }
+	int get_stride() const { return stride; }
+	F* data() { return arr.data(); }
+	const F* data() const { return arr.data(); }
 
 	//shit
-	void set(int i, int j, F val) { this->arr[i][j] = val; }
+	void set(int i, int j, F val) { this->arr[i * stride + j] = val; }
 	matrix comp(int i, int j = 0);
-	matrix row(int i);
-	matrix col(int i);
+	matrix_view<F> row(int i);
+	matrix_view<F> col(int j);
+	matrix_view<F> block(int i, int j, int m, int n);
 	matrix row_add(int r1, F c, int r2);
 	matrix row_mult(int r, F c);
 	matrix row_swap(int r1, int r2);
 	matrix t();
-	matrix submatrix(int m, int n);
-	matrix select(int* indices, int num_indices);
-
-	void debug_setup() {
-		for (int i = 0; i < rows; i++) {
-			for (int j = 0; j < cols; j++) {
-				this->bigness += pow(arr[i][j], 2);
-			}
-		}
-	}
-	
+	matrix_view<F> submatrix(int m, int n);
+	matrix_view<F> select(int* indices, int num_indices);
+
+private:
+	static void multiply_block(const matrix& A, const matrix& B, matrix& out, int i_begin, int i_end);
 };
 
-#include "matrix.hpp"
+/*
+* How expression nodes hold their operands.  Matrices are held by reference,
+* and nested nodes (which only hold references themselves) by value.
+*/
+template<typename F, typename E> struct expr_operand { typedef const E type; };
+template<typename F> struct expr_operand<F, matrix<F>> { typedef const matrix<F>& type; };
 
-#endif
+/*
+* Operands of a product are read many times each, so any operand that is not
+* already a matrix is evaluated once up front.
+*/
+template<typename F, typename E> struct product_operand { typedef const matrix<F> type; };
+template<typename F> struct product_operand<F, matrix<F>> { typedef const matrix<F>& type; };
+
+/*
+* Entrywise sum of two expressions.
+*/
+template<typename F, typename L, typename R>
+class matrix_sum : public matrix_expr<F, matrix_sum<F, L, R>>
+{
+	typename expr_operand<F, L>::type lhs;
+	typename expr_operand<F, R>::type rhs;
+
+public:
+	static const bool elementwise = L::elementwise && R::elementwise;
+
+	matrix_sum(const L& lhs, const R& rhs);
 
+	inline int get_rows() const { return lhs.get_rows(); }
+	inline int get_cols() const { return lhs.get_cols(); }
+	inline F operator () (int i, int j) const { return lhs(i, j) + rhs(i, j); }
+};
+
+/*
+* Entrywise difference of two expressions.
+*/
+template<typename F, typename L, typename R>
+class matrix_diff : public matrix_expr<F, matrix_diff<F, L, R>>
+{
+	typename expr_operand<F, L>::type lhs;
+	typename expr_operand<F, R>::type rhs;
+
+public:
+	static const bool elementwise = L::elementwise && R::elementwise;
+
+	matrix_diff(const L& lhs, const R& rhs);
+
+	inline int get_rows() const { return lhs.get_rows(); }
+	inline int get_cols() const { return lhs.get_cols(); }
+	inline F operator () (int i, int j) const { return lhs(i, j) - rhs(i, j); }
+};
+
+/*
+* Expression multiplied by a scalar.
+*/
+template<typename F, typename E>
+class matrix_scaled : public matrix_expr<F, matrix_scaled<F, E>>
+{
+	typename expr_operand<F, E>::type expr;
+	F c;
 
+public:
+	static const bool elementwise = E::elementwise;
+
+	matrix_scaled(const E& expr, F c);
+
+	inline int get_rows() const { return expr.get_rows(); }
+	inline int get_cols() const { return expr.get_cols(); }
+	inline F operator () (int i, int j) const { return expr(i, j) * c; }
+};
+
+/*
+* Matrix product of two expressions.  When a product is the outermost node it is
+* evaluated with matrix::multiply, otherwise each entry is an inner product.
+*/
+template<typename F, typename L, typename R>
+class matrix_product : public matrix_expr<F, matrix_product<F, L, R>>
+{
+	typename product_operand<F, L>::type lhs;
+	typename product_operand<F, R>::type rhs;
+
+public:
+	//the result may read from the matrix being assigned to
+	static const bool elementwise = false;
+
+	matrix_product(const L& lhs, const R& rhs);
+
+	inline const matrix<F>& left() const { return lhs; }
+	inline const matrix<F>& right() const { return rhs; }
+	inline int get_rows() const { return lhs.get_rows(); }
+	inline int get_cols() const { return rhs.get_cols(); }
+	F operator () (int i, int j) const;
+};
+
+template<typename F, typename L, typename R>
+matrix_sum<F, L, R> operator + (const matrix_expr<F, L>& lhs, const matrix_expr<F, R>& rhs);
+template<typename F, typename L, typename R>
+matrix_diff<F, L, R> operator - (const matrix_expr<F, L>& lhs, const matrix_expr<F, R>& rhs);
+template<typename F, typename L, typename R>
+matrix_product<F, L, R> operator * (const matrix_expr<F, L>& lhs, const matrix_expr<F, R>& rhs);
+template<typename F, typename E>
+matrix_scaled<F, E> operator * (const matrix_expr<F, E>& expr, typename matrix_expr<F, E>::field const& c);
+
+#include "matrix.hpp"
+
+#endif
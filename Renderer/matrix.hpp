@@ -1,3 +1,5 @@
+
+
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
@@ -7,44 +9,108 @@
 #include <cassert>
 #include <complex>
 #include <iostream>
+#include <thread>
+#include <algorithm>
 
 using namespace std;
 
+//MATRIX VIEW
+
 /*
+* Strided view.  Rows, columns and blocks of a row-major matrix are all of this form.
+*/
 template<typename F>
-matrix<F>::matrix(F* p, int m, int n) {
-	rows = m;
-	cols = n;
-	arr = vector<vector<F>>(m, vector<F>(n));
+matrix_view<F>::matrix_view(F* base, int rows, int cols, int row_stride, int col_stride) {
+	this->base = base;
+	this->rows = rows;
+	this->cols = cols;
+	this->row_stride = row_stride;
+	this->col_stride = col_stride;
+}
 
-	for (int i = 0; i < m; i++) {
-		for (int j = 0; j < n; j++) {
-			arr[i][j] = (*(p + i*n + j));
-		}
-	}
+/*
+* View of the entries whose row and column indices appear in the given lists.
+*/
+template<typename F>
+matrix_view<F>::matrix_view(F* base, int rows, int cols, int row_stride, const int* row_indices, const int* col_indices) {
+	this->base = base;
+	this->rows = rows;
+	this->cols = cols;
+	this->row_stride = row_stride;
+	this->col_stride = 1;
+	this->row_indices = row_indices;
+	this->col_indices = col_indices;
 }
+
+/*
+* View with a single row and a single column skipped.
 */
+template<typename F>
+matrix_view<F>::matrix_view(F* base, int rows, int cols, int row_stride, int skip_row, int skip_col) {
+	this->base = base;
+	this->rows = rows;
+	this->cols = cols;
+	this->row_stride = row_stride;
+	this->col_stride = 1;
+	this->skip_row = skip_row;
+	this->skip_col = skip_col;
+}
 
 //CONSTRUCTORS
 
 /*
 * Default constructor. Creates matrix of size zero.
 */
-template<typename F> 
+template<typename F>
 matrix<F>::matrix() {
 	rows = 0;
 	cols = 0;
+	stride = 0;
+}
+
+/*
+* Creates (mxn)-matrix with zero in all entries.
+*/
+template<typename F>
+matrix<F>::matrix(int m, int n) : arr(m * n) {
+	rows = m;
+	cols = n;
+	stride = n;
 }
 
 /*
 * Copy constructor.
 */
 template<typename F>
-matrix<F>::matrix(const matrix<F>& A) {
-	arr = A.arr;
+matrix<F>::matrix(const matrix<F>& A) : arr(A.arr) {
 	rows = A.rows;
 	cols = A.cols;
-	debug_setup();
+	stride = A.stride;
+}
+
+/*
+* Move constructor.  Takes over the storage of A.
+*/
+template<typename F>
+matrix<F>::matrix(matrix<F>&& A) : arr(std::move(A.arr)) {
+	rows = A.rows;
+	cols = A.cols;
+	stride = A.stride;
+	A.rows = 0;
+	A.cols = 0;
+	A.stride = 0;
+}
+
+/*
+* Copies the entries of a view into a new matrix.
+*/
+template<typename F>
+matrix<F>::matrix(const matrix_view<F>& view) : matrix(view.get_rows(), view.get_cols()) {
+	for (int i = 0; i < rows; i++) {
+		for (int j = 0; j < cols; j++) {
+			arr[i * stride + j] = view(i, j);
+		}
+	}
 }
 
 /*
@@ -52,21 +118,12 @@ matrix<F>::matrix(const matrix<F>& A) {
 *
 * @param v F list
 */
-template<typename F> 
-matrix<F>::matrix(const std::initializer_list<F>& v)
+template<typename F>
+matrix<F>::matrix(const std::initializer_list<F>& v) : arr(v)
 {
 	this->cols = 1;
-
-	int n = v.size();
-	this->rows = n;
-	this->arr = vector<vector<F>>(n);
-
-	int i = 0;
-	for (F x : v) {
-		this->arr[i] = vector<F>({ x });
-		i++;
-	}
-	debug_setup();
+	this->stride = 1;
+	this->rows = v.size();
 }
 
 /*
@@ -74,28 +131,25 @@ matrix<F>::matrix(const std::initializer_list<F>& v)
 *
 * @param v F list
 */
-template<typename F> 
-matrix<F>::matrix(const vector<F>& v)
+template<typename F>
+matrix<F>::matrix(const vector<F>& v) : arr(v)
 {
-	int n = v.size();
 	this->cols = 1;
-	this->rows = n;
-	this->arr = vector<vector<F>>(n);
-
-	for (int i = 0; i < n; i ++) { this->arr[i] = vector<F>({v[i]}); }
-	debug_setup();
+	this->stride = 1;
+	this->rows = v.size();
 }
 
 /*
 * Initializes matrix from two dimensional vector.
 * @param x two dimensional vector.
 */
-template<typename F> 
-matrix<F>::matrix(const vector<vector<F>>& x) {
-	rows = x.size();
-	cols = x[0].size();
-	arr = x;
-	debug_setup();
+template<typename F>
+matrix<F>::matrix(const vector<vector<F>>& x) : matrix(x.size(), x.size() ? x[0].size() : 0) {
+	for (int i = 0; i < rows; i++) {
+		for (int j = 0; j < cols; j++) {
+			arr[i * stride + j] = x[i][j];
+		}
+	}
 }
 
 /*
@@ -103,14 +157,15 @@ matrix<F>::matrix(const vector<vector<F>>& x) {
 */
 template<typename F>
 matrix<F>::matrix(const std::initializer_list<matrix>& col_list)
+	: matrix(col_list.size() ? col_list.begin()->rows : 0, col_list.size())
 {
-	for (matrix v : col_list) {
-		arr.push_back(v.t().arr[0]);
+	int j = 0;
+	for (const matrix& v : col_list) {
+		for (int i = 0; i < rows; i++) {
+			arr[i * stride + j] = v.arr[i * v.stride];
+		}
+		j++;
 	}
-	arr = matrix(arr).t().arr;
-	cols = arr[0].size();
-	rows = arr.size();
-	debug_setup();
 }
 
 /*
@@ -118,101 +173,393 @@ matrix<F>::matrix(const std::initializer_list<matrix>& col_list)
 */
 template<typename F>
 matrix<F>::matrix(std::vector<matrix> col_list)
+	: matrix(col_list.size() ? col_list[0].rows : 0, col_list.size())
 {
-	for (matrix v : col_list) {
-		arr.push_back(v.t().arr[0]);
+	for (int j = 0; j < cols; j++) {
+		for (int i = 0; i < rows; i++) {
+			arr[i * stride + j] = col_list[j].arr[i * col_list[j].stride];
+		}
+	}
+}
+
+/*
+* Evaluates an expression in a single pass over the entries.
+*/
+template<typename F>
+template<typename E>
+matrix<F>::matrix(const matrix_expr<F, E>& expr) : matrix(expr.self().get_rows(), expr.self().get_cols()) {
+	const E& e = expr.self();
+
+	for (int i = 0; i < rows; i++) {
+		F* row = (*this)[i];
+		for (int j = 0; j < cols; j++) {
+			row[j] = e(i, j);
+		}
 	}
-	arr = matrix(arr).t().arr;
-	cols = arr[0].size();
-	rows = arr.size();
-	debug_setup();
+}
+
+/*
+* Evaluates a product.
+*/
+template<typename F>
+template<typename L, typename R>
+matrix<F>::matrix(const matrix_product<F, L, R>& expr) : matrix() {
+	multiply(expr.left(), expr.right(), *this);
 }
 
 //OPERATORS
 template<typename F>
-inline matrix<F> matrix<F>::operator += (matrix const& other) const
-{
-	auto sum = *this + other;
-	return sum;
+matrix<F>& matrix<F>::operator = (const matrix& other) {
+	arr = other.arr;
+	rows = other.rows;
+	cols = other.cols;
+	stride = other.stride;
+	return *this;
 }
 
 template<typename F>
-inline matrix<F> matrix<F>::operator + (matrix const& other) const {
-	std::vector<vector<F>> temp = arr;
+template<typename E>
+matrix<F>& matrix<F>::operator = (const matrix_expr<F, E>& expr) {
+	const E& e = expr.self();
 
-	for (int i = 0; i < rows; i++) {
-		for (int j = 0; j < cols; j++) {
-			temp[i][j] += (F)other.arr[i][j];
+	//entrywise expressions never read an entry after it has been written, so
+	//they can be evaluated straight into our own storage
+	if (E::elementwise && rows == e.get_rows() && cols == e.get_cols()) {
+		for (int i = 0; i < rows; i++) {
+			F* row = (*this)[i];
+			for (int j = 0; j < cols; j++) {
+				row[j] = e(i, j);
+			}
 		}
+		return *this;
 	}
-	return matrix(temp);
+
+	matrix temp(expr);
+	arr.swap(temp.arr);
+	rows = temp.rows;
+	cols = temp.cols;
+	stride = temp.stride;
+	return *this;
 }
 
-template<typename F> 
-inline matrix<F> matrix<F>::operator - (matrix const& other) const{
-	vector<vector<F>> temp = arr;
+/*
+* Assigns a product.  When neither factor is this matrix the product is written
+* straight into our own storage, which it reuses if it already has the right shape.
+*/
+template<typename F>
+template<typename L, typename R>
+matrix<F>& matrix<F>::operator = (const matrix_product<F, L, R>& expr) {
+	if (&expr.left() != this && &expr.right() != this) {
+		multiply(expr.left(), expr.right(), *this);
+		return *this;
+	}
+
+	matrix temp(expr);
+	arr.swap(temp.arr);
+	rows = temp.rows;
+	cols = temp.cols;
+	stride = temp.stride;
+	return *this;
+}
+
+template<typename F>
+matrix<F>& matrix<F>::operator = (matrix&& other) {
+	arr.swap(other.arr);
+	rows = other.rows;
+	cols = other.cols;
+	stride = other.stride;
+	return *this;
+}
+
+/*
+* Adds expression to matrix in place.
+*/
+template<typename F>
+template<typename E>
+matrix<F>& matrix<F>::operator += (const matrix_expr<F, E>& expr) {
+	const E& e = expr.self();
+	assert(rows == e.get_rows() && cols == e.get_cols());
+
+	if (!E::elementwise) {
+		return *this += matrix(e);
+	}
 
 	for (int i = 0; i < rows; i++) {
+		F* row = (*this)[i];
 		for (int j = 0; j < cols; j++) {
-			temp[i][j] -= (F)other.arr[i][j];
+			row[j] += e(i, j);
 		}
-	}	
-	return matrix(temp);
-
+	}
+	return *this;
 }
 
 /*
-* Multiplication operator for scalars.
+* Subtracts expression from matrix in place.
 */
-template<typename F> 
-inline matrix<F> matrix<F>::operator * (F const& c) const {
-	vector<vector<F>> temp = vector<vector<F>>(arr);
+template<typename F>
+template<typename E>
+matrix<F>& matrix<F>::operator -= (const matrix_expr<F, E>& expr) {
+	const E& e = expr.self();
+	assert(rows == e.get_rows() && cols == e.get_cols());
+
+	if (!E::elementwise) {
+		return *this -= matrix(e);
+	}
 
 	for (int i = 0; i < rows; i++) {
+		F* row = (*this)[i];
 		for (int j = 0; j < cols; j++) {
-			temp[i][j] *= (F)c;
+			row[j] -= e(i, j);
 		}
 	}
+	return *this;
+}
 
-	return matrix(temp);
+/*
+* Multiplies matrix by scalar in place.
+*/
+template<typename F>
+matrix<F>& matrix<F>::operator *= (F const& c) {
+	for (F& x : arr) {
+		x *= c;
+	}
+	return *this;
+}
+
+/*
+* Right multiplies matrix by expression.  The product needs its own buffer, which
+* then replaces ours.
+*/
+template<typename F>
+template<typename E>
+matrix<F>& matrix<F>::operator *= (const matrix_expr<F, E>& expr) {
+	matrix temp;
+	multiply(*this, expr.self(), temp);
+	return *this = std::move(temp);
+}
+
+template<typename F>
+template<typename E>
+inline matrix<F> matrix<F>::operator + (const matrix_expr<F, E>& expr) && {
+	*this += expr;
+	return std::move(*this);
+}
+
+template<typename F>
+template<typename E>
+inline matrix<F> matrix<F>::operator - (const matrix_expr<F, E>& expr) && {
+	*this -= expr;
+	return std::move(*this);
+}
+
+template<typename F>
+inline matrix<F> matrix<F>::operator * (F const& c) && {
+	*this *= c;
+	return std::move(*this);
+}
+
+//EXPRESSIONS
+
+template<typename F, typename L, typename R>
+matrix_sum<F, L, R>::matrix_sum(const L& lhs, const R& rhs) : lhs(lhs), rhs(rhs) {
+	assert(lhs.get_rows() == rhs.get_rows() && lhs.get_cols() == rhs.get_cols());
+}
+
+template<typename F, typename L, typename R>
+matrix_diff<F, L, R>::matrix_diff(const L& lhs, const R& rhs) : lhs(lhs), rhs(rhs) {
+	assert(lhs.get_rows() == rhs.get_rows() && lhs.get_cols() == rhs.get_cols());
+}
+
+template<typename F, typename E>
+matrix_scaled<F, E>::matrix_scaled(const E& expr, F c) : expr(expr) {
+	this->c = c;
+}
+
+template<typename F, typename L, typename R>
+matrix_product<F, L, R>::matrix_product(const L& lhs, const R& rhs) : lhs(lhs), rhs(rhs) {
+	assert(this->lhs.get_cols() == this->rhs.get_rows());
+}
+
+template<typename F, typename L, typename R>
+F matrix_product<F, L, R>::operator () (int i, int j) const {
+	const F* row = lhs[i];
+	F sum = 0;
+	for (int k = 0; k < lhs.get_cols(); k++) {
+		sum += row[k] * rhs[k][j];
+	}
+	return sum;
+}
+
+template<typename F, typename L, typename R>
+inline matrix_sum<F, L, R> operator + (const matrix_expr<F, L>& lhs, const matrix_expr<F, R>& rhs) {
+	return matrix_sum<F, L, R>(lhs.self(), rhs.self());
+}
+
+template<typename F, typename L, typename R>
+inline matrix_diff<F, L, R> operator - (const matrix_expr<F, L>& lhs, const matrix_expr<F, R>& rhs) {
+	return matrix_diff<F, L, R>(lhs.self(), rhs.self());
+}
+
+/*
+* Multiplication operator for scalars.
+*/
+template<typename F, typename E>
+inline matrix_scaled<F, E> operator * (const matrix_expr<F, E>& expr, typename matrix_expr<F, E>::field const& c) {
+	return matrix_scaled<F, E>(expr.self(), c);
 }
 
 /*
 * Multiplication operator for matrices.
 */
-template<typename F> 
-inline matrix<F> matrix<F>::operator * (matrix const& other) const {
+template<typename F, typename L, typename R>
+inline matrix_product<F, L, R> operator * (const matrix_expr<F, L>& lhs, const matrix_expr<F, R>& rhs) {
+	return matrix_product<F, L, R>(lhs.self(), rhs.self());
+}
 
-	vector<vector<F>> temp(rows,vector<F>(other.cols));
-	//F* arr_begin = this->arr.data;
+/*
+* Computes out = A*B.  out must not share storage with A or B.
+*
+* Small products walk both operands along rows so the inner loop stays on
+* contiguous memory.  Larger ones are split into cache sized blocks, and above
+* parallel_threshold the rows of the result are divided between threads.
+*/
+template<typename F>
+void matrix<F>::multiply(const matrix& A, const matrix& B, matrix& out) {
+	assert(A.cols == B.rows);
+	//out may not be A or B, but its storage is kept if it already has the result's shape
+	if (out.rows == A.rows && out.cols == B.cols) {
+		for (int i = 0; i < out.rows; i++) {
+			std::fill(out[i], out[i] + out.cols, F(0));
+		}
+	}
+	else {
+		out = matrix(A.rows, B.cols);
+	}
 
-	for (int j = 0; j < other.cols; j++) {
-		for (int i = 0; i < rows; i++) {
-			for (int k = 0; k < cols; k++) {
-				temp[i][j] += arr[i][k]*(F)other.arr[k][j];
+	long long work = (long long)A.rows * A.cols * B.cols;
+
+	if (work < blocked_threshold) {
+		for (int i = 0; i < A.rows; i++) {
+			F* out_row = out[i];
+			const F* row = A[i];
+			for (int k = 0; k < A.cols; k++) {
+				F a = row[k];
+				const F* other_row = B[k];
+				for (int j = 0; j < B.cols; j++) {
+					out_row[j] += a * other_row[j];
+				}
 			}
 		}
+		return;
+	}
+
+	int nthreads = 1;
+	if (work >= parallel_threshold) {
+		nthreads = std::max(1, (int)std::thread::hardware_concurrency());
+		//give each thread at least a few register tiles worth of rows
+		nthreads = std::min(nthreads, std::max(1, A.rows / 16));
 	}
 
-	return matrix(temp);
+	if (nthreads == 1) {
+		multiply_block(A, B, out, 0, A.rows);
+		return;
+	}
+
+	std::vector<std::thread> workers;
+	int rows_per_thread = (A.rows + nthreads - 1) / nthreads;
+	for (int t = 0; t < nthreads; t++) {
+		int i_begin = t * rows_per_thread;
+		int i_end = std::min(A.rows, i_begin + rows_per_thread);
+		if (i_begin >= i_end) {
+			break;
+		}
+		workers.push_back(std::thread(multiply_block, std::cref(A), std::cref(B), std::ref(out), i_begin, i_end));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
 }
 
-template<typename F> 
-bool matrix<F>::operator == (matrix const& other) {
-	if (arr == other.arr) {
-		return true;
+/*
+* Blocked kernel for rows [i_begin, i_end) of out = A*B.  The inner dimension is
+* cut into slabs of block_rows rows of B and the columns into strips of
+* block_cols, so the piece of B being streamed stays in cache.  Four rows of the
+* result are updated together, so every entry of B that is loaded is used four
+* times while the matching entries of A sit in registers.
+*/
+template<typename F>
+void matrix<F>::multiply_block(const matrix& A, const matrix& B, matrix& out, int i_begin, int i_end) {
+	int n = A.cols;
+	int p = B.cols;
+
+	for (int kk = 0; kk < n; kk += block_rows) {
+		int k_end = std::min(n, kk + block_rows);
+
+		for (int jj = 0; jj < p; jj += block_cols) {
+			int j_end = std::min(p, jj + block_cols);
+
+			int i = i_begin;
+			for (; i + 4 <= i_end; i += 4) {
+				F* c0 = out[i];
+				F* c1 = out[i + 1];
+				F* c2 = out[i + 2];
+				F* c3 = out[i + 3];
+
+				for (int k = kk; k < k_end; k++) {
+					F a0 = A[i][k];
+					F a1 = A[i + 1][k];
+					F a2 = A[i + 2][k];
+					F a3 = A[i + 3][k];
+					const F* b = B[k];
+
+					for (int j = jj; j < j_end; j++) {
+						F b_kj = b[j];
+						c0[j] += a0 * b_kj;
+						c1[j] += a1 * b_kj;
+						c2[j] += a2 * b_kj;
+						c3[j] += a3 * b_kj;
+					}
+				}
+			}
+
+			//leftover rows
+			for (; i < i_end; i++) {
+				F* c = out[i];
+				for (int k = kk; k < k_end; k++) {
+					F a = A[i][k];
+					const F* b = B[k];
+					for (int j = jj; j < j_end; j++) {
+						c[j] += a * b[j];
+					}
+				}
+			}
+		}
+	}
+}
+
+template<typename F>
+bool matrix<F>::operator == (matrix const& other) const {
+	if (rows != other.rows || cols != other.cols) {
+		return false;
 	}
-	return false;
+	for (int i = 0; i < rows; i++) {
+		for (int j = 0; j < cols; j++) {
+			if ((*this)[i][j] != other[i][j]) {
+				return false;
+			}
+		}
+	}
+	return true;
 }
 
 /*
 * Returns string representation of matrix
 */
-template<typename F>  
+template<typename F>
 string matrix<F>::print() {
-	for (std::vector<F> v : arr) {
-		for (F x : v) {
-			std::cout << x << ", ";
+	for (int i = 0; i < rows; i++) {
+		for (int j = 0; j < cols; j++) {
+			std::cout << (*this)[i][j] << ", ";
 		}
 		std::cout << "\n";
 	}
@@ -223,137 +570,105 @@ string matrix<F>::print() {
 
 /*
 * Returns zero matrix of specified size.
-* 
+*
 * @param m,n row and column dimensions
 * @return (mxn)-matrix with zero in all entries
 */
-template<typename F> 
+template<typename F>
 matrix<F> matrix<F>::zero(int m, int n) {
-	vector<vector<F>> mat;
-
-	for (int i = 0; i < m; i++) {
-		vector<F> row;
-		for (int j = 0; j < n; j++) {
-			row.push_back(0);
-		}
-		mat.push_back(row);
-	}
-	return matrix(mat);
+	return matrix(m, n);
 }
 
 /*
 * Returns identity matrix of specified size.
-* 
+*
 * @param n size
 * @return identity matrix of size n
 */
-template<typename F> 
+template<typename F>
 matrix<F> matrix<F>::id(int n) {
-	vector<vector<F>> mat;
+	matrix mat(n, n);
 
 	for (int i = 0; i < n; i++) {
-		vector<F> row;
-		for (int j = 0; j < n; j++) {
-			if (i == j) {
-				row.push_back(1);
-			}
-			else {
-				row.push_back(0);
-			}		
-		}
-		mat.push_back(row);
+		mat[i][i] = 1;
 	}
-	return matrix(mat);
+	return mat;
 }
 
 /*
 * Returns matrix of specified size with 1 in a single entry.
-* 
+*
 * @param m,n row and column dimensions of matrix
 * @param x,y row and column index to have 1
 * @return (mxn)-matrix with 1 in (x,y)-entry and zeroes elsewhere
 */
-template<typename F> 
+template<typename F>
 matrix<F> matrix<F>::unit(int m, int n, int x, int y) {
-	vector<vector<F>> mat(m, vector<F>(n));
-
-	for (int i = 0; i < m; i++) {
-		for (int j = 0; j < n; j++) {
-			if (i == x && j == y) {
-				mat[i][j] = 1;
-			}
-			else {
-				mat[i][j] = 0;
-			}
-		}
-	}
-	return matrix(mat);
+	matrix mat(m, n);
+	mat[x][y] = 1;
+	return mat;
 }
 
-template<typename F> 
+template<typename F>
 matrix<F> matrix<F>::std_basis(int dim, int j)
 {
 	return unit(dim,1,j,0);
 }
 
 //SHIT
-/*
-template<typename F>
-matrix<F> matrix<F>::aug(matrix& B, int* side)
-{
-	int rows_new = this->rows + side[1]*side[1] * B.rows; //squaring side[n] avoids abs()
-	int cols_new = this->cols + side[0]*side[0] * B.cols;
-	F* aug_mat = new F[rows_new][cols_new];
-
-	return matrix();
-}
-*/
 
 /*
 * Returns (1xn)-matrix of i-th row.
-* 
+*
 * @param i row index
 * @return ith row of matrix
 */
 template<typename F>
 matrix<F> matrix<F>::comp(int i, int j)
 {
-	return unit(rows, cols, i, j) * this->arr[i][j];
+	return unit(rows, cols, i, j) * (*this)[i][j];
 }
 
 template<typename F>
-matrix<F> matrix<F>::row(int i) {
-	return matrix({arr[i]});
+matrix_view<F> matrix<F>::row(int i) {
+	return matrix_view<F>((*this)[i], 1, cols, stride);
 }
 
 /*
-* Returns (mx1)-matrix of j-th column.
-* 
+* Returns (mx1)-view of j-th column.
+*
 * @param j column index
-* @return j-th row of matrix
+* @return j-th column of matrix
 */
-template<typename F> 
-matrix<F> matrix<F>::col(int j) {
-	vector<vector<F>> mat(rows, vector<F>(1));
-	for (int i = 0; i < rows; i++) {
-		mat[i][0] = arr[i][j];
-	}
-	return matrix(mat);
+template<typename F>
+matrix_view<F> matrix<F>::col(int j) {
+	return matrix_view<F>(arr.data() + j, rows, 1, stride);
+}
+
+/*
+* Returns (mxn)-view of the block whose top left entry is (i,j).
+*/
+template<typename F>
+matrix_view<F> matrix<F>::block(int i, int j, int m, int n) {
+	assert(i >= 0 && j >= 0 && i + m <= rows && j + n <= cols);
+	return matrix_view<F>((*this)[i] + j, m, n, stride);
 }
 
 /*
 * Row add operation with scalar mult.
-* 
+*
 * @param r1 row to add to other row
 * @param c scalar to multiply r1 by when adding
 * @param r2 row to be added to
 * @return matrix with c*r1 added to r2
 */
-template<typename F> 
+template<typename F>
 matrix<F> matrix<F>::row_add(int r1, F c, int r2) {
-	vector<vector<F>> mat = arr;
-	mat[r2] = (matrix({ arr[r2] }) + matrix({ arr[r1] }) * c).arr[0];
-	return matrix(mat);
+	matrix mat = *this;
+	for (int j = 0; j < cols; j++) {
+		mat[r2][j] += (*this)[r1][j] * c;
+	}
+	return mat;
 }
 
 /*
@@ -363,83 +678,69 @@ matrix<F> matrix<F>::row_add(int r1, F c, int r2) {
 * @param c scalar to multiply row by
 * @return matrix with row r multiplied by c
 */
-template<typename F> 
+template<typename F>
 matrix<F> matrix<F>::row_mult(int r, F c) {
-	vector<vector<F>> mat = arr;
-	mat[r] =  (matrix({ arr[r] } ) * c).arr[0];
-	return matrix(mat);
+	matrix mat = *this;
+	for (int j = 0; j < cols; j++) {
+		mat[r][j] *= c;
+	}
+	return mat;
 }
 
 /*
 * Row swap operation.
-*		
+*
 * @param r1,r2 row indices to swap
 * @return matrix with rows r1 and r2 swapped
 */
-template<typename F> 
+template<typename F>
 matrix<F> matrix<F>::row_swap(int r1,int r2) {
-	vector<vector<F>> mat = arr;
-	mat[r1] = arr[r2];
-	mat[r2] = arr[r1];
-	return matrix(mat);
+	matrix mat = *this;
+	for (int j = 0; j < cols; j++) {
+		mat[r1][j] = (*this)[r2][j];
+		mat[r2][j] = (*this)[r1][j];
+	}
+	return mat;
 }
 
 /*
 * Returns transpose of matrix.  Switches row and column indices of entries
-* 
+*
 * @return transpose matrix
 */
-template<typename F> 
+template<typename F>
 matrix<F> matrix<F>::t() {
-	vector<vector<F>> mat(this->cols,vector<F>(this->rows));
+	matrix mat(cols, rows);
 
 	for (int i = 0; i < rows; i++) {
 		for (int j = 0; j < cols; j++) {
-			mat[j][i] = arr[i][j];
+			mat[j][i] = (*this)[i][j];
 		}
 	}
-	return matrix(mat);
+	return mat;
 }
 
 /*
-* Returns submatrix with m-th row and n-th column removed.
-* 
+* Returns view of submatrix with m-th row and n-th column removed.
+*
 * @param m,n row and column indices
-* @return (m-1 x n-1)-matrix which is the original matrix 
+* @return (m-1 x n-1)-view of the original matrix
 *	with mth row and nth col removed
 */
-template<typename F> 
-matrix<F> matrix<F>::submatrix(int m, int n) {
-	assert(m >= 0 && n >= 0 && m <= rows && n <= cols);
-
-	vector<vector<F>> temp(rows - 1, vector<F>(cols - 1));
+template<typename F>
+matrix_view<F> matrix<F>::submatrix(int m, int n) {
+	assert(m >= 0 && n >= 0 && m < rows && n < cols);
 
-	int x = 0; 
-	for (int i = 0; i < rows; i++) {
-		if (i != m) {
-			int y = 0;
-			for (int j = 0; j < cols; j++) {
-				if (j != n) {					
-					temp[x][y] = arr[i][j];
-					y++;
-				}
-			}
-			x++;
-		}
-	}
-	return matrix(temp);
+	return matrix_view<F>(arr.data(), rows - 1, cols - 1, stride, m, n);
 }
 
+/*
+* Returns view of the square submatrix with rows and columns picked out by indices.
+* The indices array must outlive the view.
+*/
 template<typename F>
-matrix<F> matrix<F>::select(int* indices, int num_indices) {
-	matrix<F> mat_new = matrix::zero(num_indices, num_indices);
-
-	for (int i = 0; i < num_indices; i++) {
-		for (int j = 0; j < num_indices; j++) {
-			mat_new.set(i, j,(*this)[indices[i]][indices[j]]);
-		}
-	}
-	return mat_new;
+matrix_view<F> matrix<F>::select(int* indices, int num_indices) {
+	return matrix_view<F>(arr.data(), num_indices, num_indices, stride, indices, indices);
 }
 
-#endif
\ No newline at end of file
+#endif
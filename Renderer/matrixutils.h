@@ -4,12 +4,25 @@
 
 #include "linalg.h"
 #include "linked_node.h"
+#include "lu_decomposition.h"
 #include <set>
 #include <unordered_set>
 #include <vector>
 
 using namespace linalg;
 
+/*
+* Result of solving a linear system Ax = b.
+*/
+template<typename F> struct linear_system
+{
+	matrix<F> x; //particular solution, size zero if inconsistent
+	int rank = 0;
+	bool consistent = false;
+
+	bool unique() const { return consistent && rank == x.get_rows(); }
+};
+
 /*
 * Various matrix related functions
 */
@@ -19,19 +32,40 @@ static F det(matrix<F> A);
 template<typename F>
 static matrix<F> adj(matrix<F> A);
 template<typename F>
+static int row_reduce(matrix<F>& A, matrix<F>& b, std::vector<int>& pivots, F tolerance = -1);
+template<typename F>
 static matrix<F> rref(matrix<F> A, matrix<F> b = matrix<F>());
 template<typename F>
 static std::vector<matrix<F>> ker(matrix<F> A);
 template<typename F>
 static matrix<F> solve(matrix<F> A, matrix<F> b);
 template<typename F>
+static linear_system<F> solve_system(matrix<F> A, matrix<F> b);
+template<typename F>
 static matrix<F> aug(matrix<F> A, matrix<F> b);
 template<typename F>
-static matrix<F> proj_matrix(initializer_list<matrix<F>> span); 
+static matrix<F> proj_matrix(const initializer_list<matrix<F>>& span);
 template<typename F>
 static matrix<F> inv(matrix<F> A);
 
-using vec = matrix<realnum>;
+/*
+* Closed-form determinant and adjugate of small fixed size matrices.  Sizes with
+* no specialization go through the dynamic LU path.
+*/
+template<typename F, int N> struct fixed_closed_form
+{
+	static F det(const fixed_matrix<F, N, N>& A);
+	static fixed_matrix<F, N, N> adj(const fixed_matrix<F, N, N>& A);
+};
+
+template<typename F, int N>
+static constexpr F det(const fixed_matrix<F, N, N>& A);
+template<typename F, int N>
+static constexpr fixed_matrix<F, N, N> adj(const fixed_matrix<F, N, N>& A);
+template<typename F, int N>
+static constexpr fixed_matrix<F, N, N> inv(const fixed_matrix<F, N, N>& A);
+
+using vec = R3::elem;
 using vertex = linked_node<vec>;
 
 #include "matrixutils.hpp"
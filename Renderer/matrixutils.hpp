@@ -5,35 +5,29 @@
 #include <assert.h>
 #include <cassert>
 #include <vector>
+#include <algorithm>
+#include <limits>
 #include "matrix.h"
 #include "matrixutils.h"
+#include "lu_decomposition.h"
 
 using namespace std;
 
 /*
-* Computes determinant of matrix via laplacian expansion.
+* Computes determinant of matrix from its LU factorization.
 */
 template<typename F> 
 F det(matrix<F> A) {
-	int size = A.get_rows();
-
-	if (size == 1) { return A[0][0]; }
-
-	F value = (F)0;
-	for (int i = 0; i < size; i++) {
-		value += pow(-1,i) * (A[0][i] * det(A.submatrix(0, i)));
-	}
-
-	return value;
+	return lu_decomposition<F>(A).det();
 }
 
 /*
-* Computes adjucate matrix.
+* Computes adjucate matrix.  For invertible A this is det(A) * A^-1, taken from a
+* single LU factorization.  Singular matrices fall back to cofactors, each minor
+* again computed by LU.
 */
 template<typename F> 
 matrix<F> adj(matrix<F> A) {
-	using vec = std::vector<F>;
-
 	int rows = A.get_rows();
 	int cols = A.get_cols();
 
@@ -43,68 +37,120 @@ matrix<F> adj(matrix<F> A) {
 
 	int size = rows;
 	if (size == 1) {		
-		return matrix<F>(vec({ (A[0][0] != 0)* (F)1 }));
+		return matrix<F>({ (A[0][0] != 0)* (F)1 });
+	}
+
+	lu_decomposition<F> lu(A);
+	if (!lu.is_singular()) {
+		return lu.inverse() * lu.det();
 	}
 
-	vector<vector<F>> cofactor(size, vector<F>(size));
-	int c = 0;
+	matrix<F> adjugate(size, size);
 	for (int i = 0; i < size; i++) {
-		c = i;
 		for (int j = 0; j < size; j++) {
-			cofactor[i][j] = pow(-1,c) * det(A.submatrix(i, j));
-			c++;
+			F sign = ((i + j) % 2) ? (F)-1 : (F)1;
+			adjugate[j][i] = sign * det<F>(A.submatrix(i, j));
 		}
 	}
-	return matrix<F>(cofactor).t();
+	return adjugate;
 
 }
 
 /*
-* Computes reduced row echelon form of matrix.
+* Gauss-Jordan elimination in place.  Reduces A to reduced row echelon form,
+* applying the same row operations to b (which may have size zero).  Pivots are
+* chosen by largest magnitude within their column, and entries no larger than
+* tolerance are treated as zero.  A negative tolerance selects one relative to
+* the size and largest entry of A.
+*
+* @param pivots filled with the column of the leading one of each nonzero row
+* @return rank of A
 */
-template<typename F> 
-matrix<F> rref(matrix<F> A, matrix<F> b) {
-	bool is_eq = b.get_cols() * b.get_rows();
-	matrix<F> mat = matrix<F>(A);
-	int rows = A.get_rows(); 
+template<typename F>
+int row_reduce(matrix<F>& A, matrix<F>& b, std::vector<int>& pivots, F tolerance) {
+	int rows = A.get_rows();
 	int cols = A.get_cols();
+	int b_cols = b.get_rows() == rows ? b.get_cols() : 0;
+
+	if (tolerance < 0) {
+		F scale = 0;
+		for (int i = 0; i < rows; i++) {
+			for (int j = 0; j < cols; j++) {
+				scale = std::max(scale, (F)abs(A[i][j]));
+			}
+		}
+		tolerance = std::numeric_limits<F>::epsilon() * scale * std::max(rows, cols);
+	}
+
+	pivots.clear();
 	int k = 0; //number of leading ones.
+	for (int j = 0; j < cols && k < rows; j++) {
+		int p = k;
+		for (int i = k + 1; i < rows; i++) {
+			if (abs(A[i][j]) > abs(A[p][j])) {
+				p = i;
+			}
+		}
 
-	auto fix_zero = [](F x) {
-		if (x < pow(10, -10)) {
-			return (F)0;
+		if (abs(A[p][j]) <= tolerance) { // no pivot in this column
+			for (int i = k; i < rows; i++) {
+				A[i][j] = 0;
+			}
+			continue;
 		}
-		return x;
-	};
 
-	for (int j = 0; j < cols; j++) {
-		for (int i = k; i < rows && k < rows; i++) {
-
-			if (abs(fix_zero(mat[i][j])) != 0) {
-				if (is_eq) {
-					b = (b.row_mult(i, 1 / mat[i][j])).row_swap(k, i);
-				}
-				mat = (mat.row_mult(i, 1 / mat[i][j])).row_swap(k, i);
-				//std::cout << aug(mat, b).to_string() << "\n";
-				
-					for (int l = 0; l < rows; l++) { // get zeroes in other entries of j-th col.
-						if (l != k) {
-							if (is_eq) {
-								b = b.row_add(i, -mat[l][j], l);
-							}
-							mat = mat.row_add(i, -mat[l][j], l);								
-						}
-						//std::cout << aug(mat, b).to_string() << "\n";
-					}
-				k++;
-				break;
+		if (p != k) {
+			std::swap_ranges(A[k] + j, A[k] + cols, A[p] + j);
+			std::swap_ranges(b[k], b[k] + b_cols, b[p]);
+		}
+
+		F* row_k = A[k];
+		F* b_k = b_cols ? b[k] : nullptr;
+		F c = 1 / row_k[j];
+		row_k[j] = 1;
+		for (int x = j + 1; x < cols; x++) {
+			row_k[x] *= c;
+		}
+		for (int x = 0; x < b_cols; x++) {
+			b_k[x] *= c;
+		}
+
+		for (int l = 0; l < rows; l++) { // get zeroes in other entries of j-th col.
+			F* row_l = A[l];
+			F factor = row_l[j];
+			if (l == k || factor == 0) {
+				continue;
+			}
+
+			row_l[j] = 0;
+			for (int x = j + 1; x < cols; x++) {
+				row_l[x] -= factor * row_k[x];
+			}
+			F* b_l = b_cols ? b[l] : nullptr;
+			for (int x = 0; x < b_cols; x++) {
+				b_l[x] -= factor * b_k[x];
 			}
 		}
+
+		pivots.push_back(j);
+		k++;
 	}
-	if (is_eq) {
-		return aug(mat, b);
+
+	return k;
+}
+
+/*
+* Computes reduced row echelon form of matrix.
+*/
+template<typename F> 
+matrix<F> rref(matrix<F> A, matrix<F> b) {
+	std::vector<int> pivots;
+	row_reduce(A, b, pivots);
+
+	if (b.get_cols() * b.get_rows()) {
+		return aug(A, b);
 	}
-	return mat;
+	return A;
 }
 
 /*
@@ -116,43 +162,29 @@ matrix<F> rref(matrix<F> A, matrix<F> b) {
 */
 template<typename F> 
 vector<matrix<F>> ker(matrix<F> A) {
-	int rows = A.get_rows();
 	int cols = A.get_cols();
-	matrix<F> mat = rref(A);
 
-	auto leading_ones = [](matrix<F> A) {
-		int rows = A.get_rows();
-		int cols = A.get_cols();
-		set<int> l_ones;
-
-		for (int i = 0; i < rows; i++) {
-			for (int j = 0; j < cols; j++) {
-				if (A[i][j] == 1) {
-					l_ones.insert(j);
-					break;
-				}
-			}
-		}
-		return l_ones;
-	};
-	set<int> ones = leading_ones(mat);
+	matrix<F> b;
+	std::vector<int> pivots;
+	int r = row_reduce(A, b, pivots);
 
 	vector<matrix<F>> kernel;
-	
+	kernel.reserve(cols - r);
+
+	int k = 0; //index of next pivot
 	for (int j = 0; j < cols; j++) { //loop through cols
-		if (ones.find(j) == ones.end()) { // if col has no leading one, construct vector
-											// in kernel
-			vector<vector<F>> v(cols,vector<F>(1)); 
-			for (int i = 0; i < cols; i++) { v[i] = { 0 }; } // set v as all zero
-
-			v[j] = { 1 };
-			int k = 0; //interator variable for rows
-			for (int i : ones) {
-				v[i] = { -mat[k][j] };
-				k++;
-			}
-			kernel.push_back(matrix<F>(v));
+		if (k < r && pivots[k] == j) {
+			k++;
+			continue;
+		}
+
+		// col has no leading one, construct vector in kernel
+		matrix<F> v(cols, 1);
+		v[j][0] = 1;
+		for (int i = 0; i < r; i++) {
+			v[pivots[i]][0] = -A[i][j];
 		}
+		kernel.push_back(std::move(v));
 	}
 
 	return kernel;
@@ -166,60 +198,288 @@ matrix<F> aug(matrix<F> A, matrix<F> b)
 {
 	assert(b.get_rows() == A.get_rows());
 
-	vector<vector<F>> mat = A.get_arr();
-	for (int i = 0; i < b.get_rows(); i++) {
+	int cols = A.get_cols();
+	matrix<F> mat(A.get_rows(), cols + b.get_cols());
+	for (int i = 0; i < A.get_rows(); i++) {
+		for (int j = 0; j < cols; j++) {
+			mat[i][j] = A[i][j];
+		}
 		for (int j = 0; j < b.get_cols(); j++) {
-			mat[i].push_back(b.get_arr()[i][j]);
+			mat[i][cols + j] = b[i][j];
 		}
 	}
 	return mat;
 }
 
+/*
+* Computes matrix of orthogonal projection onto span of given vectors.  The normal
+* equations (A^t A) X = A^t are solved by LU instead of forming the inverse.
+*/
 template<typename F>
-inline matrix<F> proj_matrix(const initializer_list<matrix<F>>& span)
+matrix<F> proj_matrix(const initializer_list<matrix<F>>& span)
 {
 	matrix<F> A = matrix<F>(span);
-	return A * (inv(A.t() * A)) * (A.t());
+	matrix<F> A_t = A.t();
+	matrix<F> gram = A_t * A;
+	return A * lu_decomposition<F>(gram).solve_many(A_t);
 }
 
+/*
+* Computes inverse of square matrix.
+*
+* @return inverse of A, or a matrix of size zero if A is singular
+*/
 template<typename F>
 matrix<F> inv(matrix<F> A)
 {
-	F d = det(A);
+	if (A.get_rows() != A.get_cols()) {
+		return matrix<F>();
+	}
+	return lu_decomposition<F>(A).inverse();
+}
 
-	if (d == (F)0) {
-		return matrix<F>::MAT_NULL();
-	} 
+//FIXED SIZE
 
-	return adj(A)*((F)1/d);
+template<typename F, int N>
+F fixed_closed_form<F, N>::det(const fixed_matrix<F, N, N>& A) {
+	return lu_decomposition<F>(A.dynamic()).det();
 }
 
-template<typename F> 
-matrix<F> solve(matrix<F> A,matrix<F> b) {
-	using mat = matrix<F>;
-	int rows = A.get_rows();
-	mat system = rref(A, b);
-	mat A_reduced = rref(A);
+template<typename F, int N>
+fixed_matrix<F, N, N> fixed_closed_form<F, N>::adj(const fixed_matrix<F, N, N>& A) {
+	return fixed_matrix<F, N, N>(::adj<F>(A.dynamic()));
+}
 
-	mat solution; {
-		mat temp;
-		for (int i = 0; i < rows; i++) {
-			temp[i] = system[i][system.get_cols() - 1];
+template<typename F> struct fixed_closed_form<F, 1>
+{
+	static constexpr F det(const fixed_matrix<F, 1, 1>& A) {
+		return A[0][0];
+	}
+
+	static constexpr fixed_matrix<F, 1, 1> adj(const fixed_matrix<F, 1, 1>&) {
+		return fixed_matrix<F, 1, 1>::id();
+	}
+};
+
+template<typename F> struct fixed_closed_form<F, 2>
+{
+	static constexpr F det(const fixed_matrix<F, 2, 2>& A) {
+		return A[0][0] * A[1][1] - A[0][1] * A[1][0];
+	}
+
+	static constexpr fixed_matrix<F, 2, 2> adj(const fixed_matrix<F, 2, 2>& A) {
+		fixed_matrix<F, 2, 2> B;
+		B[0][0] = A[1][1];  B[0][1] = -A[0][1];
+		B[1][0] = -A[1][0]; B[1][1] = A[0][0];
+		return B;
+	}
+};
+
+/*
+* Cofactor expansion along the first row.  The adjugate is the transposed matrix
+* of cofactors.
+*/
+template<typename F> struct fixed_closed_form<F, 3>
+{
+	static constexpr F det(const fixed_matrix<F, 3, 3>& A) {
+		return A[0][0] * (A[1][1] * A[2][2] - A[1][2] * A[2][1])
+			- A[0][1] * (A[1][0] * A[2][2] - A[1][2] * A[2][0])
+			+ A[0][2] * (A[1][0] * A[2][1] - A[1][1] * A[2][0]);
+	}
+
+	static constexpr fixed_matrix<F, 3, 3> adj(const fixed_matrix<F, 3, 3>& A) {
+		fixed_matrix<F, 3, 3> B;
+		B[0][0] = A[1][1] * A[2][2] - A[1][2] * A[2][1];
+		B[0][1] = A[0][2] * A[2][1] - A[0][1] * A[2][2];
+		B[0][2] = A[0][1] * A[1][2] - A[0][2] * A[1][1];
+		B[1][0] = A[1][2] * A[2][0] - A[1][0] * A[2][2];
+		B[1][1] = A[0][0] * A[2][2] - A[0][2] * A[2][0];
+		B[1][2] = A[0][2] * A[1][0] - A[0][0] * A[1][2];
+		B[2][0] = A[1][0] * A[2][1] - A[1][1] * A[2][0];
+		B[2][1] = A[0][1] * A[2][0] - A[0][0] * A[2][1];
+		B[2][2] = A[0][0] * A[1][1] - A[0][1] * A[1][0];
+		return B;
+	}
+};
+
+/*
+* Laplace expansion along the first two rows.  s are the 2x2 minors of rows 0,1
+* and c those of rows 2,3, so each is computed once and shared by every cofactor.
+*/
+template<typename F> struct fixed_closed_form<F, 4>
+{
+	struct minors
+	{
+		F s[6];
+		F c[6];
+	};
+
+	static constexpr minors pairs(const fixed_matrix<F, 4, 4>& A) {
+		minors m{};
+		m.s[0] = A[0][0] * A[1][1] - A[1][0] * A[0][1];
+		m.s[1] = A[0][0] * A[1][2] - A[1][0] * A[0][2];
+		m.s[2] = A[0][0] * A[1][3] - A[1][0] * A[0][3];
+		m.s[3] = A[0][1] * A[1][2] - A[1][1] * A[0][2];
+		m.s[4] = A[0][1] * A[1][3] - A[1][1] * A[0][3];
+		m.s[5] = A[0][2] * A[1][3] - A[1][2] * A[0][3];
+		m.c[0] = A[2][0] * A[3][1] - A[3][0] * A[2][1];
+		m.c[1] = A[2][0] * A[3][2] - A[3][0] * A[2][2];
+		m.c[2] = A[2][0] * A[3][3] - A[3][0] * A[2][3];
+		m.c[3] = A[2][1] * A[3][2] - A[3][1] * A[2][2];
+		m.c[4] = A[2][1] * A[3][3] - A[3][1] * A[2][3];
+		m.c[5] = A[2][2] * A[3][3] - A[3][2] * A[2][3];
+		return m;
+	}
+
+	static constexpr F det(const fixed_matrix<F, 4, 4>& A) {
+		minors m = pairs(A);
+		return m.s[0] * m.c[5] - m.s[1] * m.c[4] + m.s[2] * m.c[3]
+			+ m.s[3] * m.c[2] - m.s[4] * m.c[1] + m.s[5] * m.c[0];
+	}
+
+	static constexpr fixed_matrix<F, 4, 4> adj(const fixed_matrix<F, 4, 4>& A) {
+		minors m = pairs(A);
+		const F* s = m.s;
+		const F* c = m.c;
+
+		fixed_matrix<F, 4, 4> B;
+		B[0][0] = A[1][1] * c[5] - A[1][2] * c[4] + A[1][3] * c[3];
+		B[0][1] = -A[0][1] * c[5] + A[0][2] * c[4] - A[0][3] * c[3];
+		B[0][2] = A[3][1] * s[5] - A[3][2] * s[4] + A[3][3] * s[3];
+		B[0][3] = -A[2][1] * s[5] + A[2][2] * s[4] - A[2][3] * s[3];
+		B[1][0] = -A[1][0] * c[5] + A[1][2] * c[2] - A[1][3] * c[1];
+		B[1][1] = A[0][0] * c[5] - A[0][2] * c[2] + A[0][3] * c[1];
+		B[1][2] = -A[3][0] * s[5] + A[3][2] * s[2] - A[3][3] * s[1];
+		B[1][3] = A[2][0] * s[5] - A[2][2] * s[2] + A[2][3] * s[1];
+		B[2][0] = A[1][0] * c[4] - A[1][1] * c[2] + A[1][3] * c[0];
+		B[2][1] = -A[0][0] * c[4] + A[0][1] * c[2] - A[0][3] * c[0];
+		B[2][2] = A[3][0] * s[4] - A[3][1] * s[2] + A[3][3] * s[0];
+		B[2][3] = -A[2][0] * s[4] + A[2][1] * s[2] - A[2][3] * s[0];
+		B[3][0] = -A[1][0] * c[3] + A[1][1] * c[1] - A[1][2] * c[0];
+		B[3][1] = A[0][0] * c[3] - A[0][1] * c[1] + A[0][2] * c[0];
+		B[3][2] = -A[3][0] * s[3] + A[3][1] * s[1] - A[3][2] * s[0];
+		B[3][3] = A[2][0] * s[3] - A[2][1] * s[1] + A[2][2] * s[0];
+		return B;
+	}
+};
+
+template<typename F, int N>
+constexpr F det(const fixed_matrix<F, N, N>& A) {
+	return fixed_closed_form<F, N>::det(A);
+}
+
+template<typename F, int N>
+constexpr fixed_matrix<F, N, N> adj(const fixed_matrix<F, N, N>& A) {
+	return fixed_closed_form<F, N>::adj(A);
+}
+
+/*
+* Computes inverse of fixed size matrix.  The determinant is recovered from the
+* adjugate (first row of A times first column of adj A), so the cofactors are only
+* computed once.
+*
+* A is taken as singular when |det A| is at most N * epsilon times the product of
+* the largest entry of each row.  By Hadamard's inequality that product bounds
+* |det A| up to a factor N^(N/2), and it scales with every row just as det A does,
+* so a matrix with a few entries far larger than the rest (such as a translation
+* column far from the origin) is not mistaken for a singular one.
+*
+* @return inverse of A, or the zero matrix if A is singular
+*/
+template<typename F, int N>
+constexpr fixed_matrix<F, N, N> inv(const fixed_matrix<F, N, N>& A) {
+	fixed_matrix<F, N, N> B = fixed_closed_form<F, N>::adj(A);
+
+	F d = 0;
+	for (int k = 0; k < N; k++) {
+		d += A[0][k] * B[k][0];
+	}
+
+	//std::abs isn't constexpr
+	F tolerance = std::numeric_limits<F>::epsilon() * N;
+	for (int i = 0; i < N; i++) {
+		F row_scale = 0;
+		for (int j = 0; j < N; j++) {
+			F a = A[i][j] < (F)0 ? -A[i][j] : A[i][j];
+			row_scale = a > row_scale ? a : row_scale;
 		}
-		 solution = mat(temp);
+		tolerance *= row_scale;
 	}
 
+	if ((d < (F)0 ? -d : d) <= tolerance) {
+		return fixed_matrix<F, N, N>::zero();
+	}
+	B *= (F)1 / d;
+	return B;
+}
+
+/*
+* Solves Ax = b by elimination.
+*
+* @return particular solution (free variables set to zero) along with rank of A
+*	and whether the system is consistent at all
+*/
+template<typename F>
+linear_system<F> solve_system(matrix<F> A, matrix<F> b) {
+	assert(b.get_rows() == A.get_rows());
+
+	int rows = A.get_rows();
+	int cols = A.get_cols();
+	int b_cols = b.get_cols();
+
+	F scale = 0;
 	for (int i = 0; i < rows; i++) {
-		if ( A_reduced.row(i) == mat::zero( 1, A.get_cols() ) && solution[i] != 0) {
-			return mat();
+		for (int j = 0; j < cols; j++) {
+			scale = std::max(scale, (F)abs(A[i][j]));
+		}
+		for (int j = 0; j < b_cols; j++) {
+			scale = std::max(scale, (F)abs(b[i][j]));
+		}
+	}
+	F tolerance = std::numeric_limits<F>::epsilon() * scale * std::max(rows, cols);
+
+	linear_system<F> result;
+	std::vector<int> pivots;
+	result.rank = row_reduce(A, b, pivots, tolerance);
+
+	// zero rows of A must be zero in b as well
+	result.consistent = true;
+	for (int i = result.rank; i < rows && result.consistent; i++) {
+		for (int j = 0; j < b_cols; j++) {
+			if (abs(b[i][j]) > tolerance) {
+				result.consistent = false;
+				break;
+			}
 		}
 	}
 
-	if (rref(A) == matrix<F>::id(rows)) {
-		return mat();
-	} 
+	if (result.consistent) {
+		result.x = matrix<F>(cols, b_cols);
+		for (int i = 0; i < result.rank; i++) {
+			for (int j = 0; j < b_cols; j++) {
+				result.x[pivots[i]][j] = b[i][j];
+			}
+		}
+	}
+	return result;
+}
 
-	return mat();
+/*
+* Solves Ax = b.  Square invertible systems are solved by LU, anything else by
+* elimination.
+*
+* @return x, with free variables set to zero, or a matrix of size zero if the
+*	system has no solution
+*/
+template<typename F> 
+matrix<F> solve(matrix<F> A,matrix<F> b) {
+	if (A.get_rows() == A.get_cols()) {
+		lu_decomposition<F> lu(A);
+		if (!lu.is_singular()) {
+			return lu.solve_many(b);
+		}
+	}
+	return solve_system(std::move(A), std::move(b)).x;
 }
 
 
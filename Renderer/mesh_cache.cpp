@@ -0,0 +1,307 @@
+#include "mesh_cache.h"
+#include "mapped_file.h"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <atomic>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static const char mesh_file_magic[4] = { 'W', 'M', 'S', 'H' };
+static const uint32_t mesh_file_byte_order = 0x01020304;
+static const size_t mesh_file_alignment = 16;
+
+std::string mesh_cache::directory;
+
+static unsigned long process_id() {
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return (unsigned long)getpid();
+#endif
+}
+
+//atomically puts from in place of to, replacing any file already there
+static bool replace_file(const char* from, const char* to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from, to) == 0;
+#endif
+}
+
+static inline size_t align_up(size_t n) {
+    return (n + mesh_file_alignment - 1) / mesh_file_alignment * mesh_file_alignment;
+}
+
+/*
+* MurmurHash64A.  Every word goes through a multiply-shift-multiply mix before it
+* is folded in, so a change in any bit of a word reaches all bits of the state.
+*/
+static uint64_t content_hash(const char* p, size_t size) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    uint64_t hash = size * m;
+
+    size_t nwords = size / 8;
+    for (size_t i = 0; i < nwords; i++) {
+        uint64_t k;
+        memcpy(&k, p + i * 8, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        hash ^= k;
+        hash *= m;
+    }
+
+    size_t tail = size - nwords * 8;
+    if (tail != 0) {
+        uint64_t k = 0;
+        for (size_t i = 0; i < tail; i++) {
+            k |= (uint64_t)(unsigned char)p[nwords * 8 + i] << (8 * i);
+        }
+        hash ^= k;
+        hash *= m;
+    }
+
+    hash ^= hash >> r;
+    hash *= m;
+    hash ^= hash >> r;
+    return hash;
+}
+
+/*
+* Offsets of the sections after the header, relative to the end of the header.  The
+* size of the adjacency section depends on the face sizes, so it is given separately.
+*/
+struct mesh_file_layout {
+    size_t bounds;
+    size_t coords[3];
+    size_t edges;
+    size_t face_sizes;
+    size_t face_indices;
+    size_t face_adjacency;
+
+    explicit mesh_file_layout(const mesh_file_header& header) {
+        size_t offset = 0;
+        auto section = [&](size_t bytes) {
+            size_t start = offset;
+            offset = align_up(offset + bytes);
+            return start;
+        };
+        bounds = section(sizeof(realnum) * 13);
+        for (int k = 0; k < 3; k++) {
+            coords[k] = section(sizeof(realnum) * header.nvertices);
+        }
+        edges = section(sizeof(int32_t) * 2 * (size_t)header.nedges);
+        face_sizes = section(sizeof(int32_t) * (size_t)header.nfaces);
+        face_indices = section(sizeof(int32_t) * (size_t)header.nface_indices);
+        face_adjacency = offset;
+    }
+};
+
+bool save_mesh_file(const char* path, wiremesh& mesh) {
+    mesh_file_header header;
+    memcpy(header.magic, mesh_file_magic, 4);
+    header.version = mesh_file_version;
+    header.real_size = sizeof(realnum);
+    header.byte_order = mesh_file_byte_order;
+    header.nvertices = mesh.size();
+    header.nedges = (uint32_t)mesh.edges.size();
+    header.nfaces = (uint32_t)mesh.faces.size();
+    header.nface_indices = (uint32_t)mesh.faces.indices.size();
+    size_t adjacency_bytes = mesh.faces.adjacency.size();
+    header.color = mesh.color;
+    header.reserved = 0;
+
+    mesh_file_layout layout(header);
+    vector<char> body(layout.face_adjacency + adjacency_bytes, 0);
+
+    //pos and bounds
+    realnum* bounds = (realnum*)(body.data() + layout.bounds);
+    const vec* bound_vecs[4] = { &mesh.pos, &mesh.bound_min, &mesh.bound_max, &mesh.bound_center };
+    for (int v = 0; v < 4; v++) {
+        for (int k = 0; k < 3; k++) {
+            bounds[v * 3 + k] = (*bound_vecs[v])[k][0];
+        }
+    }
+    bounds[12] = mesh.bound_radius;
+
+    const realnum* coords[3] = { mesh.vertices.x(), mesh.vertices.y(), mesh.vertices.z() };
+    for (int k = 0; k < 3; k++) {
+        memcpy(body.data() + layout.coords[k], coords[k], sizeof(realnum) * header.nvertices);
+    }
+
+    int32_t* edges = (int32_t*)(body.data() + layout.edges);
+    for (size_t i = 0; i < mesh.edges.size(); i++) {
+        edges[2 * i] = mesh.edges[i].first;
+        edges[2 * i + 1] = mesh.edges[i].second;
+    }
+
+    //the face arrays are written as they are, with sizes in place of offsets
+    const face_list& faces = mesh.faces;
+    int32_t* face_sizes = (int32_t*)(body.data() + layout.face_sizes);
+    for (int f = 0; f < faces.size(); f++) {
+        face_sizes[f] = faces.offsets[f + 1] - faces.offsets[f];
+    }
+    memcpy(body.data() + layout.face_indices, faces.indices.data(), sizeof(int32_t) * faces.indices.size());
+    memcpy(body.data() + layout.face_adjacency, faces.adjacency.data(), adjacency_bytes);
+
+    header.content_hash = content_hash(body.data(), body.size());
+
+    //written next to the target under a name no other writer uses, then renamed over
+    //it in one step, so a reader sees either the old file or the whole new one
+    static std::atomic<unsigned> temp_counter(0);
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%lu.%u.tmp", (unsigned long)process_id(), temp_counter++);
+    std::string temp_path = std::string(path) + suffix;
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write((const char*)&header, sizeof(header));
+        out.write(body.data(), body.size());
+        out.close();
+        if (!out) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    if (!replace_file(temp_path.c_str(), path)) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool load_mesh_file(const char* path, wiremesh& mesh) {
+    mapped_file file;
+    if (!file.open(path) || file.get_size() < sizeof(mesh_file_header)) {
+        return false;
+    }
+
+    mesh_file_header header;
+    memcpy(&header, file.begin(), sizeof(header));
+    if (memcmp(header.magic, mesh_file_magic, 4) != 0 || header.version != mesh_file_version ||
+        header.real_size != sizeof(realnum) || header.byte_order != mesh_file_byte_order) {
+        return false;
+    }
+
+    const char* body = file.begin() + sizeof(header);
+    size_t body_size = file.get_size() - sizeof(header);
+    mesh_file_layout layout(header);
+    if (body_size < layout.face_adjacency || content_hash(body, body_size) != header.content_hash) {
+        return false;
+    }
+
+    //the hash catches damage, these catch files that were written wrong
+    int n = (int)header.nvertices;
+    const int32_t* face_sizes = (const int32_t*)(body + layout.face_sizes);
+    size_t nface_indices = 0;
+    size_t adjacency_bytes = 0;
+    for (uint32_t f = 0; f < header.nfaces; f++) {
+        if (face_sizes[f] <= 0) {
+            return false;
+        }
+        nface_indices += face_sizes[f];
+        adjacency_bytes += (size_t)face_sizes[f] * face_sizes[f];
+    }
+    if (nface_indices != header.nface_indices || body_size != layout.face_adjacency + adjacency_bytes ||
+        adjacency_bytes > INT_MAX) {
+        return false;
+    }
+
+    point_buffer<realnum> vertices(n);
+    realnum* coords[3] = { vertices.x(), vertices.y(), vertices.z() };
+    for (int k = 0; k < 3; k++) {
+        memcpy(coords[k], body + layout.coords[k], sizeof(realnum) * n);
+    }
+
+    const int32_t* edge_ends = (const int32_t*)(body + layout.edges);
+    vector< std::pair<int, int> > edges(header.nedges);
+    for (size_t i = 0; i < edges.size(); i++) {
+        int a = edge_ends[2 * i];
+        int b = edge_ends[2 * i + 1];
+        if (a < 0 || b < 0 || a >= n || b >= n) {
+            return false;
+        }
+        edges[i] = { a, b };
+    }
+
+    const int32_t* face_indices = (const int32_t*)(body + layout.face_indices);
+    for (size_t i = 0; i < nface_indices; i++) {
+        if (face_indices[i] < 0 || face_indices[i] >= n) {
+            return false;
+        }
+    }
+
+    //the face arrays are copied in whole, only the offsets are rebuilt from the sizes
+    face_list faces;
+    faces.offsets.resize(header.nfaces + 1);
+    faces.adjacency_offsets.resize(header.nfaces + 1);
+    for (uint32_t f = 0; f < header.nfaces; f++) {
+        faces.offsets[f + 1] = faces.offsets[f] + face_sizes[f];
+        faces.adjacency_offsets[f + 1] = faces.adjacency_offsets[f] + face_sizes[f] * face_sizes[f];
+    }
+    faces.indices.assign(face_indices, face_indices + nface_indices);
+    const unsigned char* face_adjacency = (const unsigned char*)(body + layout.face_adjacency);
+    faces.adjacency.assign(face_adjacency, face_adjacency + adjacency_bytes);
+
+    wiremesh loaded(std::move(vertices), std::move(edges), std::move(faces));
+    loaded.color = header.color;
+
+    //pos is wherever the mesh was last moved to, not necessarily the centroid
+    realnum bounds[13];
+    memcpy(bounds, body + layout.bounds, sizeof(bounds));
+    vec* bound_vecs[4] = { &loaded.pos, &loaded.bound_min, &loaded.bound_max, &loaded.bound_center };
+    for (int v = 0; v < 4; v++) {
+        for (int k = 0; k < 3; k++) {
+            (*bound_vecs[v])[k][0] = bounds[v * 3 + k];
+        }
+    }
+    loaded.bound_radius = bounds[12];
+
+    mesh = std::move(loaded);
+    return true;
+}
+
+//MESH_CACHE
+
+std::string mesh_cache::key(const char* name, int version, std::initializer_list<long double> params) {
+    //the same parameters give a different mesh in a build with another realnum
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%d %d", version, (int)sizeof(realnum));
+    std::string text = std::string(name) + " " + buffer;
+    for (long double param : params) {
+        snprintf(buffer, sizeof(buffer), " %.21Lg", param);
+        text += buffer;
+    }
+
+    snprintf(buffer, sizeof(buffer), "-%016llx", (unsigned long long)content_hash(text.data(), text.size()));
+    return std::string(name) + buffer;
+}
+
+std::string mesh_cache::path_of(const std::string& key) {
+    return mesh_cache::directory + "/" + key + ".wmesh";
+}
+
+bool mesh_cache::fetch(const std::string& key, wiremesh& mesh) {
+    if (mesh_cache::directory.empty()) {
+        return false;
+    }
+    return load_mesh_file(path_of(key).c_str(), mesh);
+}
+
+void mesh_cache::store(const std::string& key, wiremesh& mesh) {
+    if (mesh_cache::directory.empty()) {
+        return;
+    }
+    //a cache that can't be written to only costs the next run a rebuild
+    save_mesh_file(path_of(key).c_str(), mesh);
+}
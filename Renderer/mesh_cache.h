@@ -0,0 +1,76 @@
+#pragma once
+#include "vertex_shader.h"
+#include <string>
+#include <initializer_list>
+#include <stdint.h>
+
+/*
+* Binary mesh file: a header followed by the mesh arrays as they sit in memory, so
+* opening one is a memory mapping and a few bulk copies instead of rebuilding edges,
+* faces and bounds.  All sections start on 16 byte boundaries:
+*
+*   mesh_file_header
+*   pos, bound_min, bound_max, bound_center (3 realnum each), bound_radius
+*   x, y and z coordinates (nvertices realnum each)
+*   edges (nedges pairs of int32)
+*   face sizes (nfaces int32), then their vertex indices (nface_indices int32)
+*   face adjacency (size * size bytes per face)
+*
+* Numbers are in the byte order of the machine that wrote the file, and realnum is
+* whatever the writing build used; a file from a different build is rejected.
+*/
+struct mesh_file_header {
+    char magic[4];
+    uint32_t version;
+    //sizeof(realnum) and byte order mark of the writer
+    uint32_t real_size;
+    uint32_t byte_order;
+    uint32_t nvertices;
+    uint32_t nedges;
+    uint32_t nfaces;
+    uint32_t nface_indices;
+    uint32_t color;
+    uint32_t reserved;
+    //hash of everything after the header
+    uint64_t content_hash;
+};
+
+static const uint32_t mesh_file_version = 1;
+
+/*
+* @returns - false if the file can't be written.
+*/
+bool save_mesh_file(const char* path, wiremesh& mesh);
+
+/*
+* @returns - false if the file is missing, from another version or build, or fails
+* its content hash, leaving mesh untouched.
+*/
+bool load_mesh_file(const char* path, wiremesh& mesh);
+
+/*
+* On disk cache of generated meshes, e.g. the procedural primitives, as mesh files
+* named after a key built from the generator's parameters.  Off until a directory
+* is set.
+*/
+class mesh_cache {
+public:
+    //directory the cache files go in, which must exist.  Empty turns the cache off.
+    static void set_directory(const std::string& directory) { mesh_cache::directory = directory; }
+    static const std::string& get_directory() { return mesh_cache::directory; }
+
+    /*
+    * Key of a generator called name run with the given parameters.  The version is
+    * the generator's own and must change whenever its output does, or meshes built
+    * by older code keep being served.
+    */
+    static std::string key(const char* name, int version, std::initializer_list<long double> params);
+
+    //loads the mesh cached under key, false on a miss or with the cache off
+    static bool fetch(const std::string& key, wiremesh& mesh);
+    static void store(const std::string& key, wiremesh& mesh);
+
+private:
+    static std::string directory;
+    static std::string path_of(const std::string& key);
+};
@@ -0,0 +1,828 @@
+#include "mesh_io.h"
+#include "mapped_file.h"
+#include <thread>
+#include <string>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <stdint.h>
+
+//files smaller than this are parsed on the calling thread
+static const size_t parallel_bytes = 1 << 20;
+
+/*
+* Vertices and polygons as parsed, before they become a wiremesh.  Polygon i has
+* face_sizes[i] vertices, listed in order in face_indices.  relative lists the
+* entries of face_indices that count from the first vertex of this chunk rather
+* than from the start of the file (negative OBJ indices).
+*/
+struct mesh_data {
+    vector<realnum> xs;
+    vector<realnum> ys;
+    vector<realnum> zs;
+    vector<int> face_sizes;
+    vector<int> face_indices;
+    vector<int> relative;
+};
+
+/* ---------- TEXT ---------- */
+
+static inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && is_blank(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static inline const char* line_end(const char* p, const char* end) {
+    const char* newline = (const char*)memchr(p, '\n', end - p);
+    return newline ? newline : end;
+}
+
+/*
+* Parses a decimal number at p, advancing p past it.  Up to 19 significant digits
+* are kept in an integer and scaled once at the end, so there is no allocation
+* and no locale lookup as with strtod.
+*/
+static bool parse_real(const char*& p, const char* end, realnum& out) {
+    static const realnum powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    p = skip_blanks(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any_digits = false;
+    auto take_digit = [&](int d, bool fraction) {
+        any_digits = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + d;
+            digits += (mantissa != 0);
+            exponent -= fraction;
+        }
+        else {
+            exponent += !fraction;
+        }
+    };
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        take_digit(*p++ - '0', false);
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            take_digit(*p++ - '0', true);
+        }
+    }
+    if (!any_digits) {
+        return false;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative_exponent = (*p == '-');
+            p++;
+        }
+        int e = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            e = min(e * 10 + (*p++ - '0'), 100000);
+        }
+        exponent += negative_exponent ? -e : e;
+    }
+
+    realnum value = (realnum)mantissa;
+    if (exponent < 0) {
+        value /= (-exponent <= 22) ? powers_of_ten[-exponent] : pow((realnum)10, (realnum)-exponent);
+    }
+    else if (exponent > 0) {
+        value *= (exponent <= 22) ? powers_of_ten[exponent] : pow((realnum)10, (realnum)exponent);
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+static bool parse_int(const char*& p, const char* end, long long& out) {
+    p = skip_blanks(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return false;
+    }
+    long long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = min(value * 10 + (*p++ - '0'), 1LL << 40);
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+/* ---------- CHUNKS ---------- */
+
+//number of chunks to parse bytes bytes in
+static int chunk_count(size_t bytes) {
+    if (bytes < parallel_bytes) {
+        return 1;
+    }
+    return max(1, (int)std::thread::hardware_concurrency());
+}
+
+/*
+* Splits [begin, end) into nchunks pieces of about the same size that start and end
+* on line boundaries.
+* @returns - nchunks + 1 bounds, chunk t is [bounds[t], bounds[t + 1]).
+*/
+static vector<const char*> split_lines(const char* begin, const char* end, int nchunks) {
+    vector<const char*> bounds(nchunks + 1, end);
+    bounds[0] = begin;
+    for (int t = 1; t < nchunks; t++) {
+        const char* p = max(bounds[t - 1], begin + (end - begin) * t / nchunks);
+        //already on a line start if the previous character ends a line
+        if (p > begin && p < end && p[-1] != '\n') {
+            p = line_end(p, end);
+            p += (p < end);
+        }
+        bounds[t] = p;
+    }
+    return bounds;
+}
+
+//calls f(t, bounds[t], bounds[t + 1]) for every chunk, each on its own thread
+template<typename func>
+static void for_chunks(const vector<const char*>& bounds, func f) {
+    int nchunks = (int)bounds.size() - 1;
+    if (nchunks == 1) {
+        f(0, bounds[0], bounds[1]);
+        return;
+    }
+
+    vector<std::thread> workers;
+    for (int t = 0; t < nchunks; t++) {
+        workers.push_back(std::thread(f, t, bounds[t], bounds[t + 1]));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+/*
+* Joins the chunks in order, turning chunk relative indices into file indices.
+* @returns - false if a face refers to a vertex that doesn't exist.
+*/
+static bool merge_chunks(vector<mesh_data>& chunks, mesh_data& out) {
+    size_t nvertices = 0;
+    size_t nfaces = 0;
+    size_t nindices = 0;
+    for (const mesh_data& chunk : chunks) {
+        nvertices += chunk.xs.size();
+        nfaces += chunk.face_sizes.size();
+        nindices += chunk.face_indices.size();
+    }
+    out.xs.reserve(nvertices);
+    out.ys.reserve(nvertices);
+    out.zs.reserve(nvertices);
+    out.face_sizes.reserve(nfaces);
+    out.face_indices.reserve(nindices);
+
+    for (mesh_data& chunk : chunks) {
+        int offset = (int)out.xs.size();
+        for (int i : chunk.relative) {
+            chunk.face_indices[i] += offset;
+        }
+        out.xs.insert(out.xs.end(), chunk.xs.begin(), chunk.xs.end());
+        out.ys.insert(out.ys.end(), chunk.ys.begin(), chunk.ys.end());
+        out.zs.insert(out.zs.end(), chunk.zs.begin(), chunk.zs.end());
+        out.face_sizes.insert(out.face_sizes.end(), chunk.face_sizes.begin(), chunk.face_sizes.end());
+        out.face_indices.insert(out.face_indices.end(), chunk.face_indices.begin(), chunk.face_indices.end());
+        chunk = mesh_data();
+    }
+
+    int n = (int)out.xs.size();
+    for (int i : out.face_indices) {
+        if (i < 0 || i >= n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ---------- MESH ---------- */
+
+/*
+* Boundary edges of the polygons as (i, j) with i < j, each once, sorted.  Edges are
+* bucketed by their lower end, so only the short buckets need sorting.
+*/
+static vector< std::pair<int, int> > polygon_edges(const mesh_data& data) {
+    int n = (int)data.xs.size();
+
+    auto for_each_edge = [&](auto f) {
+        const int* indices = data.face_indices.data();
+        for (int size : data.face_sizes) {
+            for (int k = 0; k < size && size > 1; k++) {
+                int a = indices[k];
+                int b = indices[(k + 1) % size];
+                //a two vertex polygon has one edge, not two
+                if (a != b && !(size == 2 && k == 1)) {
+                    f(min(a, b), max(a, b));
+                }
+            }
+            indices += size;
+        }
+    };
+
+    vector<int> bucket_start(n + 1, 0);
+    for_each_edge([&](int a, int) { bucket_start[a + 1]++; });
+    for (int i = 0; i < n; i++) {
+        bucket_start[i + 1] += bucket_start[i];
+    }
+    vector<int> next(bucket_start.begin(), bucket_start.end() - 1);
+    vector<int> ends(bucket_start[n]);
+    for_each_edge([&](int a, int b) { ends[next[a]++] = b; });
+
+    vector< std::pair<int, int> > edges;
+    edges.reserve(ends.size() / 2);
+    for (int a = 0; a < n; a++) {
+        int* first = ends.data() + bucket_start[a];
+        int* last = ends.data() + bucket_start[a + 1];
+        std::sort(first, last);
+        last = std::unique(first, last);
+        for (int* b = first; b < last; b++) {
+            edges.push_back({ a, *b });
+        }
+    }
+    return edges;
+}
+
+//adds the face of the polygon indices[0..size), its adjacency joining consecutive vertices
+static void add_polygon_face(face_list& faces, const int* indices, int size) {
+    faces.push_back(indices, size);
+    unsigned char* adjacency = faces.back_adjacency();
+    for (int k = 0; k < size; k++) {
+        int next = (k + 1) % size;
+        adjacency[k * size + next] = 1;
+        adjacency[next * size + k] = 1;
+    }
+}
+
+static void build_mesh(mesh_data& data, wiremesh& mesh) {
+    int n = (int)data.xs.size();
+    point_buffer<realnum> vertices(n);
+    std::copy(data.xs.begin(), data.xs.end(), vertices.x());
+    std::copy(data.ys.begin(), data.ys.end(), vertices.y());
+    std::copy(data.zs.begin(), data.zs.end(), vertices.z());
+
+    vector< std::pair<int, int> > edges = polygon_edges(data);
+
+    int nfaces = 0;
+    int nindices = 0;
+    for (int size : data.face_sizes) {
+        int pieces = (size == 3 || size == 4) ? 1 : max(size - 2, 0);
+        nfaces += pieces;
+        nindices += (pieces == 1) ? size : pieces * 3;
+    }
+
+    face_list faces;
+    faces.reserve(nfaces, nindices);
+    const int* indices = data.face_indices.data();
+    for (int size : data.face_sizes) {
+        if (size == 3 || size == 4) {
+            add_polygon_face(faces, indices, size);
+        }
+        //fan out from the first vertex
+        for (int k = 1; size > 4 && k < size - 1; k++) {
+            int triangle[3] = { indices[0], indices[k], indices[k + 1] };
+            add_polygon_face(faces, triangle, 3);
+        }
+        indices += size;
+    }
+
+    mesh = wiremesh(std::move(vertices), std::move(edges), std::move(faces));
+}
+
+/* ---------- OBJ ---------- */
+
+static bool parse_obj_chunk(const char* p, const char* end, mesh_data& out) {
+    while (p < end) {
+        const char* eol = line_end(p, end);
+        p = skip_blanks(p, eol);
+
+        if (eol - p >= 2 && p[0] == 'v' && is_blank(p[1])) {
+            p++;
+            realnum x, y, z;
+            if (!parse_real(p, eol, x) || !parse_real(p, eol, y) || !parse_real(p, eol, z)) {
+                return false;
+            }
+            out.xs.push_back(x);
+            out.ys.push_back(y);
+            out.zs.push_back(z);
+        }
+        else if (eol - p >= 2 && p[0] == 'f' && is_blank(p[1])) {
+            p++;
+            int size = 0;
+            while ((p = skip_blanks(p, eol)) < eol) {
+                long long index;
+                //checked before the casts below, which would wrap a large index into range
+                if (!parse_int(p, eol, index) || index == 0 || index > INT_MAX || index < -INT_MAX) {
+                    return false;
+                }
+                //texture and normal indices
+                while (p < eol && !is_blank(*p)) {
+                    p++;
+                }
+
+                if (index > 0) {
+                    out.face_indices.push_back((int)(index - 1));
+                }
+                else {
+                    out.relative.push_back((int)out.face_indices.size());
+                    out.face_indices.push_back((int)(out.xs.size() + index));
+                }
+                size++;
+            }
+            out.face_sizes.push_back(size);
+        }
+
+        p = eol + (eol < end);
+    }
+    return true;
+}
+
+static bool parse_obj(const char* begin, const char* end, mesh_data& data) {
+    vector<const char*> bounds = split_lines(begin, end, chunk_count(end - begin));
+    vector<mesh_data> chunks(bounds.size() - 1);
+    vector<char> ok(chunks.size());
+    for_chunks(bounds, [&](int t, const char* chunk_begin, const char* chunk_end) {
+        ok[t] = parse_obj_chunk(chunk_begin, chunk_end, chunks[t]);
+    });
+
+    if (std::find(ok.begin(), ok.end(), 0) != ok.end()) {
+        return false;
+    }
+    return merge_chunks(chunks, data);
+}
+
+bool load_obj(const char* path, wiremesh& mesh) {
+    mapped_file file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    mesh_data data;
+    if (!parse_obj(file.begin(), file.end(), data)) {
+        return false;
+    }
+    build_mesh(data, mesh);
+    return true;
+}
+
+/* ---------- PLY ---------- */
+
+enum ply_type { ply_int8, ply_uint8, ply_int16, ply_uint16, ply_int32, ply_uint32, ply_float32, ply_float64, ply_invalid };
+enum ply_format { ply_ascii, ply_binary_le, ply_binary_be };
+
+struct ply_property {
+    std::string name;
+    ply_type type;
+    //type of the length of a list property
+    ply_type count_type;
+    bool is_list;
+};
+
+struct ply_element {
+    std::string name;
+    long long count;
+    vector<ply_property> properties;
+};
+
+static ply_type ply_type_of(const std::string& name) {
+    static const char* names[][2] = {
+        { "char", "int8" }, { "uchar", "uint8" }, { "short", "int16" }, { "ushort", "uint16" },
+        { "int", "int32" }, { "uint", "uint32" }, { "float", "float32" }, { "double", "float64" }
+    };
+    for (int i = 0; i < ply_invalid; i++) {
+        if (name == names[i][0] || name == names[i][1]) {
+            return (ply_type)i;
+        }
+    }
+    return ply_invalid;
+}
+
+static int ply_type_size(ply_type type) {
+    static const int sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+    return sizes[type];
+}
+
+//bytes per item of a binary element, or -1 if it has lists and varies
+static int ply_stride(const ply_element& element) {
+    int stride = 0;
+    for (const ply_property& property : element.properties) {
+        if (property.is_list) {
+            return -1;
+        }
+        stride += ply_type_size(property.type);
+    }
+    return stride;
+}
+
+static inline double read_binary(const char* p, ply_type type, bool swap) {
+    unsigned char bytes[8];
+    int size = ply_type_size(type);
+    memcpy(bytes, p, size);
+    if (swap) {
+        std::reverse(bytes, bytes + size);
+    }
+
+    switch (type) {
+    case ply_int8: { signed char v; memcpy(&v, bytes, 1); return v; }
+    case ply_uint8: { unsigned char v; memcpy(&v, bytes, 1); return v; }
+    case ply_int16: { int16_t v; memcpy(&v, bytes, 2); return v; }
+    case ply_uint16: { uint16_t v; memcpy(&v, bytes, 2); return v; }
+    case ply_int32: { int32_t v; memcpy(&v, bytes, 4); return v; }
+    case ply_uint32: { uint32_t v; memcpy(&v, bytes, 4); return v; }
+    case ply_float32: { float v; memcpy(&v, bytes, 4); return v; }
+    default: { double v; memcpy(&v, bytes, 8); return v; }
+    }
+}
+
+/*
+* Reads one item of element at p, advancing p past it, and calls on_value(i, k, v)
+* for every value v of property i, with k the position in the list (0 for scalars).
+*/
+template<typename func>
+static bool read_ply_item(const char*& p, const char* end, const ply_element& element, ply_format format, func on_value) {
+    bool swap = (format == ply_binary_be);
+    int nproperties = (int)element.properties.size();
+
+    if (format == ply_ascii) {
+        const char* eol = line_end(p, end);
+        for (int i = 0; i < nproperties; i++) {
+            const ply_property& property = element.properties[i];
+            realnum value;
+            long long count = 1;
+            if (property.is_list) {
+                if (!parse_int(p, eol, count) || count < 0) {
+                    return false;
+                }
+            }
+            for (long long k = 0; k < count; k++) {
+                if (!parse_real(p, eol, value)) {
+                    return false;
+                }
+                on_value(i, (int)k, value);
+            }
+        }
+        p = eol + (eol < end);
+        return true;
+    }
+
+    for (int i = 0; i < nproperties; i++) {
+        const ply_property& property = element.properties[i];
+        long long count = 1;
+        if (property.is_list) {
+            if (end - p < ply_type_size(property.count_type)) {
+                return false;
+            }
+            count = (long long)read_binary(p, property.count_type, swap);
+            p += ply_type_size(property.count_type);
+        }
+        int size = ply_type_size(property.type);
+        if (count < 0 || (end - p) / size < count) {
+            return false;
+        }
+        for (long long k = 0; k < count; k++) {
+            on_value(i, (int)k, read_binary(p, property.type, swap));
+            p += size;
+        }
+    }
+    return true;
+}
+
+//index of the property called name (or alt_name) of element, -1 if missing
+static int ply_find(const ply_element& element, const char* name, const char* alt_name = nullptr) {
+    for (int i = 0; i < (int)element.properties.size(); i++) {
+        const std::string& property = element.properties[i].name;
+        if (property == name || (alt_name != nullptr && property == alt_name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+* Reads the ascii header at the start of [p, end), advancing p to the first byte of
+* the body.
+*/
+static bool parse_ply_header(const char*& p, const char* end, ply_format& format, vector<ply_element>& elements) {
+    bool have_format = false;
+    bool first_line = true;
+
+    while (p < end) {
+        const char* eol = line_end(p, end);
+        vector<std::string> words;
+        const char* q = p;
+        while ((q = skip_blanks(q, eol)) < eol) {
+            const char* word_end = q;
+            while (word_end < eol && !is_blank(*word_end)) {
+                word_end++;
+            }
+            words.push_back(std::string(q, word_end));
+            q = word_end;
+        }
+        p = eol + (eol < end);
+
+        if (first_line) {
+            if (words.size() != 1 || words[0] != "ply") {
+                return false;
+            }
+            first_line = false;
+            continue;
+        }
+        if (words.empty() || words[0] == "comment" || words[0] == "obj_info") {
+            continue;
+        }
+
+        if (words[0] == "format" && words.size() >= 2) {
+            if (words[1] == "ascii") format = ply_ascii;
+            else if (words[1] == "binary_little_endian") format = ply_binary_le;
+            else if (words[1] == "binary_big_endian") format = ply_binary_be;
+            else return false;
+            have_format = true;
+        }
+        else if (words[0] == "element" && words.size() == 3) {
+            ply_element element;
+            element.name = words[1];
+            element.count = atoll(words[2].c_str());
+            if (element.count < 0) {
+                return false;
+            }
+            elements.push_back(element);
+        }
+        else if (words[0] == "property" && !elements.empty()) {
+            ply_property property;
+            property.is_list = (words.size() == 5 && words[1] == "list");
+            if (property.is_list) {
+                property.count_type = ply_type_of(words[2]);
+                property.type = ply_type_of(words[3]);
+                property.name = words[4];
+                if (property.count_type == ply_invalid || property.count_type == ply_float32 || property.count_type == ply_float64) {
+                    return false;
+                }
+            }
+            else if (words.size() == 3) {
+                property.count_type = ply_invalid;
+                property.type = ply_type_of(words[1]);
+                property.name = words[2];
+            }
+            else {
+                return false;
+            }
+            if (property.type == ply_invalid) {
+                return false;
+            }
+            elements.back().properties.push_back(property);
+        }
+        else if (words[0] == "end_header") {
+            return have_format;
+        }
+        else {
+            return false;
+        }
+    }
+    return false;
+}
+
+/*
+* Splits the items of element starting at begin into chunks for parsing.  Ascii
+* lines and fixed size binary items can be split up front; binary items with lists
+* make up a single chunk that runs to the end of the file and stops after count items.
+*/
+static bool ply_chunks(const char* begin, const char* end, const ply_element& element, ply_format format, vector<const char*>& bounds, vector<long long>& first_item) {
+    int stride = ply_stride(element);
+
+    if (format == ply_ascii) {
+        const char* p = begin;
+        for (long long i = 0; i < element.count; i++) {
+            if (p >= end) {
+                return false;
+            }
+            p = line_end(p, end);
+            p += (p < end);
+        }
+        bounds = split_lines(begin, p, chunk_count(p - begin));
+        //ascii chunks are read to their end, however many lines that is
+        first_item.assign(bounds.size(), -1);
+        return true;
+    }
+
+    if (stride < 0) {
+        bounds = { begin, end };
+        first_item = { 0, element.count };
+        return true;
+    }
+
+    if ((end - begin) / max(stride, 1) < element.count) {
+        return false;
+    }
+    int nchunks = chunk_count((size_t)stride * element.count);
+    bounds.resize(nchunks + 1);
+    first_item.resize(nchunks + 1);
+    for (int t = 0; t <= nchunks; t++) {
+        first_item[t] = element.count * t / nchunks;
+        bounds[t] = begin + stride * first_item[t];
+    }
+    return true;
+}
+
+/*
+* Parses the chunks of element into one mesh_data each, appended to chunks: vertices
+* from the x, y and z properties if x_index is not -1, or polygons from the list at
+* face_index if that is not -1.  Elements with neither are only read past.
+* @param element_end [out] - first byte after the element.
+*/
+static bool parse_ply_element(const ply_element& element, ply_format format, const vector<const char*>& bounds, const vector<long long>& first_item, vector<mesh_data>& chunks, int x_index, int y_index, int z_index, int face_index, const char*& element_end) {
+    int nchunks = (int)bounds.size() - 1;
+    int stride = (format == ply_ascii) ? -1 : ply_stride(element);
+    bool vertices = (x_index >= 0);
+    bool faces = (face_index >= 0);
+
+    //split up front, so there is nothing to read through
+    if (!vertices && !faces && (format == ply_ascii || stride >= 0)) {
+        element_end = bounds.back();
+        return true;
+    }
+
+    vector<mesh_data> local(nchunks);
+    vector<const char*> stop(nchunks);
+    vector<char> ok(nchunks, 1);
+
+    for_chunks(bounds, [&](int t, const char* chunk_begin, const char* chunk_end) {
+        mesh_data& out = local[t];
+        const char* p = chunk_begin;
+        long long nitems = (first_item[t] < 0) ? -1 : first_item[t + 1] - first_item[t];
+
+        //fixed size binary vertices are read straight from their offsets
+        if (vertices && stride >= 0) {
+            int offsets[3] = { 0, 0, 0 };
+            int indices[3] = { x_index, y_index, z_index };
+            for (int c = 0; c < 3; c++) {
+                for (int i = 0; i < indices[c]; i++) {
+                    offsets[c] += ply_type_size(element.properties[i].type);
+                }
+            }
+            bool swap = (format == ply_binary_be);
+            out.xs.resize(nitems);
+            out.ys.resize(nitems);
+            out.zs.resize(nitems);
+            for (long long item = 0; item < nitems; item++) {
+                const char* base = p + stride * item;
+                out.xs[item] = read_binary(base + offsets[0], element.properties[x_index].type, swap);
+                out.ys[item] = read_binary(base + offsets[1], element.properties[y_index].type, swap);
+                out.zs[item] = read_binary(base + offsets[2], element.properties[z_index].type, swap);
+            }
+            stop[t] = chunk_end;
+            return;
+        }
+
+        if (faces && nitems > 0) {
+            out.face_sizes.reserve(nitems);
+            out.face_indices.reserve(nitems * 3);
+        }
+
+        realnum xyz[3] = { 0, 0, 0 };
+        int face_size = 0;
+        auto on_value = [&](int i, int, realnum value) {
+            if (i == x_index) xyz[0] = value;
+            else if (i == y_index) xyz[1] = value;
+            else if (i == z_index) xyz[2] = value;
+            else if (i == face_index) {
+                //out of int range becomes -1, which merge_chunks rejects with the rest
+                out.face_indices.push_back(value >= 0 && value <= INT_MAX ? (int)value : -1);
+                face_size++;
+            }
+        };
+
+        long long item = 0;
+        for (; p < chunk_end && item != nitems; item++) {
+            if (!read_ply_item(p, chunk_end, element, format, on_value)) {
+                ok[t] = 0;
+                return;
+            }
+            if (faces) {
+                out.face_sizes.push_back(face_size);
+                face_size = 0;
+            }
+            else if (vertices) {
+                out.xs.push_back(xyz[0]);
+                out.ys.push_back(xyz[1]);
+                out.zs.push_back(xyz[2]);
+            }
+        }
+        //a chunk with a known item count must not run out of file first
+        ok[t] = (nitems < 0 || item == nitems);
+        stop[t] = p;
+    });
+
+    if (std::find(ok.begin(), ok.end(), 0) != ok.end()) {
+        return false;
+    }
+    for (mesh_data& chunk : local) {
+        chunks.push_back(std::move(chunk));
+    }
+    element_end = stop.back();
+    return true;
+}
+
+static bool parse_ply(const char* begin, const char* end, mesh_data& data) {
+    const char* p = begin;
+    ply_format format = ply_ascii;
+    vector<ply_element> elements;
+    if (!parse_ply_header(p, end, format, elements)) {
+        return false;
+    }
+
+    //vertex chunks come before face chunks, so face indices need no offset
+    vector<mesh_data> chunks;
+    long long nvertices = 0;
+    for (const ply_element& element : elements) {
+        vector<const char*> bounds;
+        vector<long long> first_item;
+        if (!ply_chunks(p, end, element, format, bounds, first_item)) {
+            return false;
+        }
+
+        int x_index = -1, y_index = -1, z_index = -1, face_index = -1;
+        if (element.name == "vertex") {
+            x_index = ply_find(element, "x");
+            y_index = ply_find(element, "y");
+            z_index = ply_find(element, "z");
+            if (x_index < 0 || y_index < 0 || z_index < 0) {
+                return false;
+            }
+            nvertices += element.count;
+        }
+        else if (element.name == "face") {
+            face_index = ply_find(element, "vertex_indices", "vertex_index");
+            if (face_index < 0) {
+                return false;
+            }
+        }
+
+        if (!parse_ply_element(element, format, bounds, first_item, chunks, x_index, y_index, z_index, face_index, p)) {
+            return false;
+        }
+    }
+
+    return merge_chunks(chunks, data) && (long long)data.xs.size() == nvertices;
+}
+
+bool load_ply(const char* path, wiremesh& mesh) {
+    mapped_file file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    mesh_data data;
+    if (!parse_ply(file.begin(), file.end(), data)) {
+        return false;
+    }
+    build_mesh(data, mesh);
+    return true;
+}
+
+/* ---------- OTHER ---------- */
+
+bool load_mesh(const char* path, wiremesh& mesh) {
+    std::string name(path);
+    size_t dot = name.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+
+    std::string extension = name.substr(dot + 1);
+    for (char& c : extension) {
+        c = (char)tolower(c);
+    }
+    if (extension == "obj") {
+        return load_obj(path, mesh);
+    }
+    if (extension == "ply") {
+        return load_ply(path, mesh);
+    }
+    return false;
+}
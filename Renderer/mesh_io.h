@@ -0,0 +1,22 @@
+#pragma once
+#include "vertex_shader.h"
+
+/*
+* Loaders for Wavefront OBJ and PLY (ascii or binary) meshes.  The file is memory
+* mapped and split into chunks of whole lines that are parsed on separate threads,
+* straight into flat arrays, so large files load at about the speed they can be
+* read.  Triangles and quads become faces as they are, larger polygons are split
+* into triangles, and the edges are the polygon boundaries.
+*
+* OBJ: reads v and f lines (f v, f v/vt, f v/vt/vn and f v//vn, negative indices
+* included) and ignores everything else.
+* PLY: reads x, y, z of the vertex element and the vertex_indices (or vertex_index)
+* list of the face element and skips any other properties and elements.
+*
+* @returns - false if the file can't be read or is malformed, leaving mesh untouched.
+*/
+bool load_obj(const char* path, wiremesh& mesh);
+bool load_ply(const char* path, wiremesh& mesh);
+
+//load_obj or load_ply by the file extension
+bool load_mesh(const char* path, wiremesh& mesh);
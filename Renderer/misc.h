@@ -1,5 +1,6 @@
 #pragma once
 #include "matrix.h"
+#include "fixed_matrix.h"
 #define PI 3.14159265358979323846  /* pi */
 
 
@@ -13,6 +14,12 @@ struct pt {
         y = static_cast<int>(mat[1][0]);
     }
 
+    template<typename K, int M, int N>
+    pt(const fixed_matrix<K, M, N>& mat) {
+        x = static_cast<int>(mat[0][0]);
+        y = static_cast<int>(mat[1][0]);
+    }
+
     bool operator == (const pt& other) {
         return (this->x == other.x) && (this->y == other.y);
     }
@@ -1,8 +1,21 @@
 #pragma once
 #include "matrix.h"
+#include "fixed_matrix.h"
+#include "quaternion.h"
+#include "simd_vec.h"
 #include "misc.h"
 #include "inner_products.h"
-typedef long double realnum;
+#include <limits>
+
+/*
+* Scalar type of geometry, projection and shading.  Define RENDERER_PRECISION as
+* float, double or long double for the whole build (e.g. /D RENDERER_PRECISION=float)
+* to trade accuracy for speed; float and double take the vectorized batch kernels.
+*/
+#ifndef RENDERER_PRECISION
+#define RENDERER_PRECISION long double
+#endif
+typedef RENDERER_PRECISION realnum;
 
 /*
 * Base vector space class. 
@@ -46,19 +59,19 @@ public:
 * @tparam dim - dimension
 * @tparam product - dot product by default, or get creative if you want.
 */
-template<typename F,int dim, typename product = inner_products::std_coord<F, dim>>
-class coord_space : public inner_product_space<F, matrix<F>, product> {
+template<typename F,int n, typename product = inner_products::std_coord<F, n>>
+class coord_space : public inner_product_space<F, fixed_matrix<F, n, 1>, product> {
 public:
-	static const int dim = dim;
-	static matrix<F> zero() {
-		return matrix<F>::zero(dim, 1);
+	static const int dim = n;
+	static fixed_matrix<F, n, 1> zero() {
+		return fixed_matrix<F, n, 1>::zero();
 	}
 };
 
 class R3 : public coord_space<realnum, 3, inner_products::std_coord<realnum, 3>> {
 public:
 	//inner product
-	static inline realnum ip(elem v, elem w) {
+	static inline realnum ip(const elem& v, const elem& w) {
 		realnum val = 0;
 		for (int i = 0; i < 3; i++) {
 			val += v[i][0] * w[i][0];
@@ -66,18 +79,23 @@ public:
 		return val;
 	}
 
-	static inline realnum norm(elem v) { return sqrt(ip(v, v)); }
+	static inline realnum norm(const elem& v) { return sqrt(ip(v, v)); }
 
-	static inline matrix<realnum> cross_prod_matrix(elem v) {
-		return matrix<realnum>({
-			{ 0		     , v[2][0]*-1 , v[1][0]    },
-			{ v[2][0]    , 0          , v[0][0]*-1 },
-			{ v[1][0]*-1 , v[0][0]    , 0          }
+	static inline fixed_matrix<realnum, 3, 3> cross_prod_matrix(const elem& v) {
+		return fixed_matrix<realnum, 3, 3>({
+			{ 0		     , v[2][0]    , v[1][0]*-1 },
+			{ v[2][0]*-1 , 0          , v[0][0]    },
+			{ v[1][0]    , v[0][0]*-1 , 0          }
 			});
 	}
 
-	static inline elem cross_prod(elem v, elem w) {
-		return cross_prod_matrix(v) * w;
+	//w x v, i.e. cross_prod_matrix(v) * w
+	static inline elem cross_prod(const elem& v, const elem& w) {
+		return elem({
+			v[2][0] * w[1][0] - v[1][0] * w[2][0],
+			v[0][0] * w[2][0] - v[2][0] * w[0][0],
+			v[1][0] * w[0][0] - v[0][0] * w[1][0]
+			});
 	}
 
 	/*
@@ -86,9 +104,9 @@ public:
 	* @param k - 3x1 matrix.
 	* @param theta - rotation angle.
 	*/
-	static inline elem rot_axis(elem k, double theta) {
+	static inline fixed_matrix<realnum, 3, 3> rot_axis(elem k, double theta) {
 		k = R3::unitize(k);
-		return matrix<realnum>::id(3)*cos(theta) + cross_prod_matrix(k)*sin(theta) + (k*(k.t()))*(1-cos(theta));
+		return fixed_matrix<realnum, 3, 3>::id()*cos(theta) + cross_prod_matrix(k)*sin(theta) + (k*(k.t()))*(1-cos(theta));
 	}
 
 	/*
@@ -101,42 +119,61 @@ public:
 	* affine subspace in R3. If there is no intersection, or the intersection is 
 	* the entire 1-dimensional space, returns the zero vector.
 	*/
-	static inline elem line_plane_intersect(elem line_start, elem line_dir, elem plane_pos, elem plane_normal) {
+	static inline elem line_plane_intersect(const elem& line_start, const elem& line_dir, const elem& plane_pos, const elem& plane_normal) {
 		field dot = ip(line_dir, plane_normal);
 		bool is_orthogonal = (dot == 0);
 		return (line_start + line_dir * (ip(plane_pos - line_start, plane_normal)* pow(dot + is_orthogonal,-1)))*(!is_orthogonal);
 	}
+
+	//the same helpers on the padded vec3 type
+	using coord_space<realnum, 3, inner_products::std_coord<realnum, 3>>::unitize;
+
+	static inline realnum ip(const simd_vec::vec3<realnum>& v, const simd_vec::vec3<realnum>& w) { return simd_vec::dot(v, w); }
+	static inline realnum norm(const simd_vec::vec3<realnum>& v) { return simd_vec::norm(v); }
+	static inline simd_vec::vec3<realnum> unitize(const simd_vec::vec3<realnum>& v) { return simd_vec::unitize(v); }
+	static inline simd_vec::vec3<realnum> cross_prod(const simd_vec::vec3<realnum>& v, const simd_vec::vec3<realnum>& w) { return simd_vec::cross(w, v); }
+
+	static inline simd_vec::vec3<realnum> line_plane_intersect(const simd_vec::vec3<realnum>& line_start, const simd_vec::vec3<realnum>& line_dir, const simd_vec::vec3<realnum>& plane_pos, const simd_vec::vec3<realnum>& plane_normal) {
+		realnum dot = simd_vec::dot(line_dir, plane_normal);
+		if (dot == 0) {
+			return simd_vec::vec3<realnum>();
+		}
+		return line_start + line_dir * (simd_vec::dot(plane_pos - line_start, plane_normal) / dot);
+	}
 	
 	/* 
 	* Rotation matrix in R3 about x-axis.
 	*/
-	inline static matrix<realnum> rotatex(double angle) {
-		return matrix<realnum>({
-			{ cos(angle), -sin(angle), 0},
-			{ sin(angle), cos(angle) , 0 },
-			{ 0         ,           0, 1 }
+	inline static fixed_matrix<realnum, 3, 3> rotatex(double angle) {
+		realnum c = cos(angle), s = sin(angle);
+		return fixed_matrix<realnum, 3, 3>({
+			{ c , s, 0 },
+			{ -s, c, 0 },
+			{ 0 , 0, 1 }
 			});
 	}
 
 	/*
 	* Rotation matrix in R3 about y-axis.
 	*/
-	inline static matrix<realnum> rotatey(double angle) {
-		return matrix<realnum>({
-			{cos(angle), 0, -sin(angle)},
+	inline static fixed_matrix<realnum, 3, 3> rotatey(double angle) {
+		realnum c = cos(angle), s = sin(angle);
+		return fixed_matrix<realnum, 3, 3>({
+			{c, 0, s},
 			{0, 1, 0},
-			{ sin(angle), 0, cos(angle) }
+			{ -s, 0, c }
 			});
 	}
 
 	/*
 	* Rotation matrix in R3 about y-axis.
 	*/
-	inline static matrix<realnum> rotatez(double angle) {
-		matrix<realnum> rot = matrix<realnum>({
+	inline static fixed_matrix<realnum, 3, 3> rotatez(double angle) {
+		realnum c = cos(angle), s = sin(angle);
+		fixed_matrix<realnum, 3, 3> rot = fixed_matrix<realnum, 3, 3>({
 			{1, 0, 0},
-			{ 0, cos(angle), -sin(angle) },
-			{ 0, sin(angle), cos(angle), }
+			{ 0, c, s },
+			{ 0, -s, c, }
 			});
 		return rot;
 	}
@@ -147,35 +184,74 @@ public:
 	* @param beta - pitch
 	* @param gamma - roll
 	*/
-	inline static matrix<realnum> rotate_intr(double alpha, double beta, double gamma) {
-		return rotatex(alpha) * rotatey(beta) * rotatez(gamma);
+	inline static fixed_matrix<realnum, 3, 3> rotate_intr(double alpha, double beta, double gamma) {
+		return rotate_intr_q(alpha, beta, gamma).to_matrix();
+	}
+
+	/*
+	* rotate_intr as a quaternion, the same as rotatex(alpha) * rotatey(beta) * rotatez(gamma).
+	*/
+	inline static quaternion<realnum> rotate_intr_q(double alpha, double beta, double gamma) {
+		quaternion<realnum> qx(cos(alpha / 2), 0, 0, -sin(alpha / 2));
+		quaternion<realnum> qy(cos(beta / 2), 0, sin(beta / 2), 0);
+		quaternion<realnum> qz(cos(gamma / 2), -sin(gamma / 2), 0, 0);
+		return qx * qy * qz;
 	}
 
 };
 
 /*
-* Uses gram-schmidt process to orthonormalize a set of vectors.
-* @param start - element of "basis" list to start algorithm from.
-* @returns - std::vector containing new set of vector.
+* Orthonormalizes a contiguous block of vectors in place by modified gram-schmidt,
+* i.e. the Q of a QR decomposition.  Each vector is projected against the
+* finished ones twice, which keeps the result orthogonal to working precision
+* even for nearly dependent input.  A vector whose remaining norm is negligible
+* next to its original norm is dropped instead of being divided by ~0.
+* 
+* @param vecs - vectors to orthonormalize.
+* @param count - number of vectors.
+* @returns - rank of the span.  The orthonormal basis is vecs[0..rank), in input
+* order.
 */
 template<typename parent_space>
-vector<class parent_space::elem> orthonormalize(vector<class parent_space::elem> vecs) {
+int orthonormalize_in_place(class parent_space::elem* vecs, int count) {
 	using vec = class parent_space::elem;
+	using F = typename parent_space::field;
+
+	const F tolerance = std::numeric_limits<F>::epsilon() * 16 * vec::get_rows();
 
-	//GRAM SCHMIDT PROCESS
-	vector<vec> new_vecs;
-	for (vec w : vecs) {
-		w = w * (1/parent_space::norm(w));
+	int rank = 0;
+	for (int k = 0; k < count; k++) {
+		vec w = vecs[k];
+		F original = parent_space::norm(w);
 
-		vec w_new = vec(w);
+		for (int pass = 0; pass < 2; pass++) {
+			for (int i = 0; i < rank; i++) {
+				w -= vecs[i] * parent_space::ip(vecs[i], w);
+			}
+		}
 
-		for (vec u : new_vecs) {
-			w_new = w_new - u * parent_space::ip(u, w);
+		F remaining = parent_space::norm(w);
+		if (!(remaining > tolerance * original)) {
+			continue;
 		}
-		w_new = w_new * (1/parent_space::norm(w_new));
-		new_vecs.push_back(w_new);
+
+		w *= 1 / remaining;
+		vecs[rank] = w;
+		rank++;
 	}
-	return new_vecs;
+	return rank;
+}
+
+/*
+* Uses gram-schmidt process to orthonormalize a set of vectors.
+* @returns - std::vector containing an orthonormal basis of their span.  Dependent
+* vectors are left out, so it may be shorter than the input.
+*/
+template<typename parent_space>
+vector<class parent_space::elem> orthonormalize(vector<class parent_space::elem> vecs) {
+	int rank = orthonormalize_in_place<parent_space>(vecs.data(), (int)vecs.size());
+	vecs.resize(rank);
+	return vecs;
 }
 
 
@@ -0,0 +1,53 @@
+#pragma once
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include "fixed_matrix.h"
+
+using namespace std;
+
+/*
+* Quaternion w + xi + yj + zk.  Unit quaternions represent rotations of R3: q
+* rotates v to q v q*, and the product pq is the rotation q followed by p.
+* Composing two rotations costs 16 multiplications, and renormalizing a unit
+* quaternion is all it takes to undo accumulated rounding.
+*/
+template<typename F> class quaternion
+{
+public:
+	F w;
+	F x;
+	F y;
+	F z;
+
+	//constructors
+	constexpr quaternion() : w(1), x(0), y(0), z(0) {}
+	constexpr quaternion(F w, F x, F y, F z) : w(w), x(x), y(y), z(z) {}
+
+	//operator overloads
+	constexpr quaternion operator * (quaternion const& other) const;
+	constexpr quaternion operator * (F const& c) const { return quaternion(w * c, x * c, y * c, z * c); }
+	constexpr quaternion operator + (quaternion const& other) const { return quaternion(w + other.w, x + other.x, y + other.y, z + other.z); }
+	quaternion& operator *= (quaternion const& other) { return *this = *this * other; }
+
+	//static functions
+	static constexpr quaternion id() { return quaternion(); }
+	static quaternion axis_angle(const fixed_matrix<F, 3, 1>& axis, F theta);
+	static quaternion from_matrix(const fixed_matrix<F, 3, 3>& R);
+	static quaternion slerp(const quaternion& a, quaternion b, F t);
+
+	//shit
+	constexpr quaternion conj() const { return quaternion(w, -x, -y, -z); }
+	constexpr F dot(quaternion const& other) const { return w * other.w + x * other.x + y * other.y + z * other.z; }
+	F norm() const { return sqrt(this->dot(*this)); }
+	quaternion unitize() const { return *this * (1 / this->norm()); }
+	void normalize() { *this = this->unitize(); }
+
+	constexpr fixed_matrix<F, 3, 1> rotate(const fixed_matrix<F, 3, 1>& v) const;
+	constexpr fixed_matrix<F, 3, 3> to_matrix() const;
+	void to_axis_angle(fixed_matrix<F, 3, 1>& axis, F& theta) const;
+};
+
+#include "quaternion.hpp"
+
+#endif
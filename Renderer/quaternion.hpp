@@ -0,0 +1,141 @@
+
+#ifndef QUATERNION_HPP
+#define QUATERNION_HPP
+
+#include "quaternion.h"
+#include <math.h>
+#include <algorithm>
+
+//OPERATORS
+
+/*
+* Hamilton product.
+*/
+template<typename F>
+constexpr quaternion<F> quaternion<F>::operator * (quaternion const& other) const {
+	return quaternion(
+		w * other.w - x * other.x - y * other.y - z * other.z,
+		w * other.x + x * other.w + y * other.z - z * other.y,
+		w * other.y - x * other.z + y * other.w + z * other.x,
+		w * other.z + x * other.y - y * other.x + z * other.w
+	);
+}
+
+//STATIC FUNCTIONS
+
+/*
+* Rotation by angle theta about axis, counterclockwise looking down the axis.
+* @param axis - nonzero vector, need not be of unit length.
+*/
+template<typename F>
+quaternion<F> quaternion<F>::axis_angle(const fixed_matrix<F, 3, 1>& axis, F theta) {
+	F len = sqrt(axis[0][0] * axis[0][0] + axis[1][0] * axis[1][0] + axis[2][0] * axis[2][0]);
+	F s = sin(theta / 2) / len;
+	return quaternion(cos(theta / 2), axis[0][0] * s, axis[1][0] * s, axis[2][0] * s);
+}
+
+/*
+* Unit quaternion of a rotation matrix (Shepperd's method).  The largest of
+* w, x, y, z is recovered first so the square root is never of a small number.
+*/
+template<typename F>
+quaternion<F> quaternion<F>::from_matrix(const fixed_matrix<F, 3, 3>& R) {
+	F trace = R[0][0] + R[1][1] + R[2][2];
+	quaternion q;
+
+	if (trace > R[0][0] && trace > R[1][1] && trace > R[2][2]) {
+		F s = sqrt(1 + trace) * 2;
+		q = quaternion(s / 4, (R[2][1] - R[1][2]) / s, (R[0][2] - R[2][0]) / s, (R[1][0] - R[0][1]) / s);
+	}
+	else if (R[0][0] >= R[1][1] && R[0][0] >= R[2][2]) {
+		F s = sqrt(1 + R[0][0] - R[1][1] - R[2][2]) * 2;
+		q = quaternion((R[2][1] - R[1][2]) / s, s / 4, (R[0][1] + R[1][0]) / s, (R[0][2] + R[2][0]) / s);
+	}
+	else if (R[1][1] >= R[2][2]) {
+		F s = sqrt(1 + R[1][1] - R[0][0] - R[2][2]) * 2;
+		q = quaternion((R[0][2] - R[2][0]) / s, (R[0][1] + R[1][0]) / s, s / 4, (R[1][2] + R[2][1]) / s);
+	}
+	else {
+		F s = sqrt(1 + R[2][2] - R[0][0] - R[1][1]) * 2;
+		q = quaternion((R[1][0] - R[0][1]) / s, (R[0][2] + R[2][0]) / s, (R[1][2] + R[2][1]) / s, s / 4);
+	}
+	return q.unitize();
+}
+
+/*
+* Spherical linear interpolation between unit quaternions, along the shorter arc.
+* @param t - 0 gives a, 1 gives b.
+*/
+template<typename F>
+quaternion<F> quaternion<F>::slerp(const quaternion& a, quaternion b, F t) {
+	F d = a.dot(b);
+	if (d < 0) {
+		b = b * -1;
+		d = -d;
+	}
+
+	//nearly parallel, sin(angle) ~ 0 so interpolate linearly instead
+	if (d > (F)0.9995) {
+		return (a * (1 - t) + b * t).unitize();
+	}
+
+	F angle = acos(std::min(d, (F)1));
+	F s = sin(angle);
+	return a * (sin((1 - t) * angle) / s) + b * (sin(t * angle) / s);
+}
+
+//SHIT
+
+/*
+* Rotates v, using v + 2w(u x v) + 2u x (u x v) where u = (x, y, z).
+*/
+template<typename F>
+constexpr fixed_matrix<F, 3, 1> quaternion<F>::rotate(const fixed_matrix<F, 3, 1>& v) const {
+	F vx = v[0][0], vy = v[1][0], vz = v[2][0];
+
+	//t = 2(u x v)
+	F tx = 2 * (y * vz - z * vy);
+	F ty = 2 * (z * vx - x * vz);
+	F tz = 2 * (x * vy - y * vx);
+
+	fixed_matrix<F, 3, 1> out;
+	out[0][0] = vx + w * tx + (y * tz - z * ty);
+	out[1][0] = vy + w * ty + (z * tx - x * tz);
+	out[2][0] = vz + w * tz + (x * ty - y * tx);
+	return out;
+}
+
+/*
+* Rotation matrix of a unit quaternion.
+*/
+template<typename F>
+constexpr fixed_matrix<F, 3, 3> quaternion<F>::to_matrix() const {
+	F xx = x * x, yy = y * y, zz = z * z;
+	F xy = x * y, xz = x * z, yz = y * z;
+	F wx = w * x, wy = w * y, wz = w * z;
+
+	fixed_matrix<F, 3, 3> R;
+	R[0][0] = 1 - 2 * (yy + zz); R[0][1] = 2 * (xy - wz);     R[0][2] = 2 * (xz + wy);
+	R[1][0] = 2 * (xy + wz);     R[1][1] = 1 - 2 * (xx + zz); R[1][2] = 2 * (yz - wx);
+	R[2][0] = 2 * (xz - wy);     R[2][1] = 2 * (yz + wx);     R[2][2] = 1 - 2 * (xx + yy);
+	return R;
+}
+
+/*
+* Axis and angle (in [0, 2pi)) of a unit quaternion.  The identity has no
+* well-defined axis and reports the x-axis.
+*/
+template<typename F>
+void quaternion<F>::to_axis_angle(fixed_matrix<F, 3, 1>& axis, F& theta) const {
+	F c = std::max((F)-1, std::min(w, (F)1));
+	theta = 2 * acos(c);
+
+	F s = sqrt(1 - c * c);
+	if (s < (F)1e-9) {
+		axis = fixed_matrix<F, 3, 1>::std_basis(0);
+		return;
+	}
+	axis = { x / s, y / s, z / s };
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+#ifndef SIMD_H
+#define SIMD_H
+
+/*
+* Instruction set the build targets.  RENDERER_AVX is set when the compiler is
+* allowed AVX (/arch:AVX, /arch:AVX2, -mavx), otherwise RENDERER_SSE2 on any x86
+* target that guarantees SSE2.  Code guarded by neither has to fall back to
+* plain scalars.
+*/
+#if defined(__AVX__)
+#define RENDERER_AVX
+#define RENDERER_SSE2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RENDERER_SSE2
+#include <emmintrin.h>
+#endif
+
+#endif
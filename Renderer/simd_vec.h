@@ -0,0 +1,85 @@
+#pragma once
+#ifndef SIMD_VEC_H
+#define SIMD_VEC_H
+
+#include "fixed_matrix.h"
+
+using namespace std;
+
+/*
+* Small fixed vectors for hot geometry code, kept in their own namespace so the
+* componentwise min, max and the rest don't sit next to std's.  linalg::vec3 is
+* the one used with realnum.
+*
+* Everything here is plain scalar code.  These vectors are nearly always built
+* from separate scalars just before use, and loading them back as one SSE
+* register stalls on store forwarding; SSE versions ran slower in the shader
+* and in camera::proj than what the compiler makes of the scalar loops.
+*/
+namespace simd_vec {
+
+/*
+* Plain 3-vector.  A fourth lane is carried and kept at zero, so a vec3 has the
+* layout of a vec4 of the same type.  Converts to and from the column vectors
+* used by R3.
+*/
+template<typename F> struct vec3
+{
+	F x;
+	F y;
+	F z;
+	F pad;
+
+	constexpr vec3() : x(0), y(0), z(0), pad(0) {}
+	constexpr vec3(F x, F y, F z) : x(x), y(y), z(z), pad(0) {}
+	explicit constexpr vec3(const fixed_matrix<F, 3, 1>& v) : x(v[0][0]), y(v[1][0]), z(v[2][0]), pad(0) {}
+
+	constexpr fixed_matrix<F, 3, 1> elem() const { return { x, y, z }; }
+};
+
+/*
+* Plain 4-vector, e.g. homogeneous coordinates.
+*/
+template<typename F> struct vec4
+{
+	F x;
+	F y;
+	F z;
+	F w;
+
+	constexpr vec4() : x(0), y(0), z(0), w(0) {}
+	constexpr vec4(F x, F y, F z, F w) : x(x), y(y), z(z), w(w) {}
+	constexpr vec4(const vec3<F>& v, F w) : x(v.x), y(v.y), z(v.z), w(w) {}
+	explicit constexpr vec4(const fixed_matrix<F, 4, 1>& v) : x(v[0][0]), y(v[1][0]), z(v[2][0]), w(v[3][0]) {}
+
+	constexpr fixed_matrix<F, 4, 1> elem() const { return { x, y, z, w }; }
+};
+
+//arithmetic
+template<typename F> constexpr vec3<F> operator + (const vec3<F>& a, const vec3<F>& b) { return vec3<F>(a.x + b.x, a.y + b.y, a.z + b.z); }
+template<typename F> constexpr vec3<F> operator - (const vec3<F>& a, const vec3<F>& b) { return vec3<F>(a.x - b.x, a.y - b.y, a.z - b.z); }
+template<typename F> constexpr vec3<F> operator * (const vec3<F>& a, F c) { return vec3<F>(a.x * c, a.y * c, a.z * c); }
+template<typename F> constexpr vec4<F> operator + (const vec4<F>& a, const vec4<F>& b) { return vec4<F>(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+template<typename F> constexpr vec4<F> operator - (const vec4<F>& a, const vec4<F>& b) { return vec4<F>(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+template<typename F> constexpr vec4<F> operator * (const vec4<F>& a, F c) { return vec4<F>(a.x * c, a.y * c, a.z * c, a.w * c); }
+
+//geometry
+template<typename F> F dot(const vec3<F>& a, const vec3<F>& b);
+template<typename F> F dot(const vec4<F>& a, const vec4<F>& b);
+template<typename F> vec3<F> cross(const vec3<F>& a, const vec3<F>& b);
+template<typename F> F norm(const vec3<F>& a);
+template<typename F> F norm(const vec4<F>& a);
+template<typename F> vec3<F> unitize(const vec3<F>& a);
+template<typename F> vec4<F> unitize(const vec4<F>& a);
+template<typename F> vec3<F> lerp(const vec3<F>& a, const vec3<F>& b, F t);
+template<typename F> vec4<F> lerp(const vec4<F>& a, const vec4<F>& b, F t);
+template<typename F> vec3<F> min(const vec3<F>& a, const vec3<F>& b);
+template<typename F> vec3<F> max(const vec3<F>& a, const vec3<F>& b);
+template<typename F> vec4<F> min(const vec4<F>& a, const vec4<F>& b);
+template<typename F> vec4<F> max(const vec4<F>& a, const vec4<F>& b);
+
+}
+
+#include "simd_vec.hpp"
+
+#endif
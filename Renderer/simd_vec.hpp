@@ -0,0 +1,87 @@
+
+#ifndef SIMD_VEC_HPP
+#define SIMD_VEC_HPP
+
+#include "simd_vec.h"
+#include <math.h>
+#include <algorithm>
+
+namespace simd_vec {
+
+//SCALAR
+
+template<typename F>
+F dot(const vec3<F>& a, const vec3<F>& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+template<typename F>
+F dot(const vec4<F>& a, const vec4<F>& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+/*
+* Right handed cross product a x b.
+*/
+template<typename F>
+vec3<F> cross(const vec3<F>& a, const vec3<F>& b) {
+	return vec3<F>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+template<typename F>
+F norm(const vec3<F>& a) {
+	return sqrt(dot(a, a));
+}
+
+template<typename F>
+F norm(const vec4<F>& a) {
+	return sqrt(dot(a, a));
+}
+
+template<typename F>
+vec3<F> unitize(const vec3<F>& a) {
+	return a * (1 / norm(a));
+}
+
+template<typename F>
+vec4<F> unitize(const vec4<F>& a) {
+	return a * (1 / norm(a));
+}
+
+/*
+* Linear interpolation, a at t = 0 and b at t = 1.
+*/
+template<typename F>
+vec3<F> lerp(const vec3<F>& a, const vec3<F>& b, F t) {
+	return a + (b - a) * t;
+}
+
+template<typename F>
+vec4<F> lerp(const vec4<F>& a, const vec4<F>& b, F t) {
+	return a + (b - a) * t;
+}
+
+//componentwise
+template<typename F>
+vec3<F> min(const vec3<F>& a, const vec3<F>& b) {
+	return vec3<F>(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+}
+
+template<typename F>
+vec3<F> max(const vec3<F>& a, const vec3<F>& b) {
+	return vec3<F>(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+}
+
+template<typename F>
+vec4<F> min(const vec4<F>& a, const vec4<F>& b) {
+	return vec4<F>(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z), std::min(a.w, b.w));
+}
+
+template<typename F>
+vec4<F> max(const vec4<F>& a, const vec4<F>& b) {
+	return vec4<F>(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w));
+}
+
+}
+
+#endif
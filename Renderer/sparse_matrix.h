@@ -0,0 +1,66 @@
+#pragma once
+#ifndef SPARSE_MATRIX_H
+#define SPARSE_MATRIX_H
+
+#include "matrix.h"
+#include <vector>
+
+using namespace std;
+
+/*
+* Single (i,j,val) entry, used to assemble sparse matrices.
+*/
+template<typename F> struct triplet
+{
+	int row;
+	int col;
+	F val;
+};
+
+/*
+* Class representing an (mxn)-matrix in compressed sparse row form.  The nonzero
+* entries of row i are vals[row_ptr[i]..row_ptr[i+1]), with their column indices
+* in col_idx, sorted.  Memory scales with the number of nonzero entries.
+*
+* The transpose of a CSR matrix is its CSC form, so t() covers column access.
+*/
+template<typename F = double> class sparse_matrix
+{
+protected:
+	int rows;
+	int cols;
+	std::vector<int> row_ptr;
+	std::vector<int> col_idx;
+	std::vector<F> vals;
+
+public:
+	//constructors
+	sparse_matrix<F>();
+	sparse_matrix<F>(int m, int n);
+	sparse_matrix<F>(int m, int n, const std::vector<triplet<F>>& entries);
+	sparse_matrix<F>(int m, int n, std::vector<int> row_ptr, std::vector<int> col_idx, std::vector<F> vals);
+	explicit sparse_matrix<F>(const matrix<F>& A);
+
+	//operator overloads
+	F operator () (int i, int j) const;
+	matrix<F> operator * (const matrix<F>& B) const;
+	std::vector<F> operator * (const std::vector<F>& x) const;
+	bool operator == (sparse_matrix const& other) const;
+
+	//get fields
+	int get_rows() const { return rows; }
+	int get_cols() const { return cols; }
+	int get_nnz() const { return (int)vals.size(); }
+	int row_size(int i) const { return row_ptr[i + 1] - row_ptr[i]; }
+	const int* row_cols(int i) const { return col_idx.data() + row_ptr[i]; }
+	const F* row_vals(int i) const { return vals.data() + row_ptr[i]; }
+
+	//shit
+	matrix<F> dense() const;
+	sparse_matrix t() const;
+	sparse_matrix select(const int* indices, int num_indices) const;
+};
+
+#include "sparse_matrix.hpp"
+
+#endif
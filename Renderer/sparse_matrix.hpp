@@ -0,0 +1,245 @@
+
+#ifndef SPARSE_MATRIX_HPP
+#define SPARSE_MATRIX_HPP
+
+#include "sparse_matrix.h"
+#include <assert.h>
+#include <cassert>
+#include <algorithm>
+#include <utility>
+
+//CONSTRUCTORS
+
+/*
+* Default constructor. Creates matrix of size zero.
+*/
+template<typename F>
+sparse_matrix<F>::sparse_matrix() : row_ptr(1, 0) {
+	this->rows = 0;
+	this->cols = 0;
+}
+
+/*
+* Creates (mxn) zero matrix.
+*/
+template<typename F>
+sparse_matrix<F>::sparse_matrix(int m, int n) : row_ptr(m + 1, 0) {
+	this->rows = m;
+	this->cols = n;
+}
+
+/*
+* Assembles (mxn)-matrix from a list of entries in any order.  When an entry is
+* given more than once the last value wins, as with matrix::set.
+*/
+template<typename F>
+sparse_matrix<F>::sparse_matrix(int m, int n, const std::vector<triplet<F>>& entries) : row_ptr(m + 1, 0) {
+	this->rows = m;
+	this->cols = n;
+
+	//bucket entries by row, keeping their input order
+	for (const triplet<F>& e : entries) {
+		assert(e.row >= 0 && e.row < m && e.col >= 0 && e.col < n);
+		row_ptr[e.row + 1]++;
+	}
+	for (int i = 0; i < m; i++) {
+		row_ptr[i + 1] += row_ptr[i];
+	}
+
+	std::vector<int> next(row_ptr.begin(), row_ptr.end() - 1);
+	std::vector<std::pair<int, F>> bucket(entries.size());
+	for (const triplet<F>& e : entries) {
+		bucket[next[e.row]++] = { e.col, e.val };
+	}
+
+	//sort each row by column, dropping all but the last of any repeated entry
+	col_idx.reserve(entries.size());
+	vals.reserve(entries.size());
+	int begin = 0;
+	for (int i = 0; i < m; i++) {
+		int end = row_ptr[i + 1];
+		std::stable_sort(bucket.begin() + begin, bucket.begin() + end,
+			[](const std::pair<int, F>& a, const std::pair<int, F>& b) { return a.first < b.first; });
+
+		row_ptr[i] = (int)col_idx.size();
+		for (int k = begin; k < end; k++) {
+			if (k + 1 < end && bucket[k + 1].first == bucket[k].first) {
+				continue;
+			}
+			col_idx.push_back(bucket[k].first);
+			vals.push_back(bucket[k].second);
+		}
+		begin = end;
+	}
+	row_ptr[m] = (int)col_idx.size();
+}
+
+/*
+* Takes over arrays that are already in compressed sparse row form, the columns of
+* each row sorted and without repeats.
+*/
+template<typename F>
+sparse_matrix<F>::sparse_matrix(int m, int n, std::vector<int> row_ptr, std::vector<int> col_idx, std::vector<F> vals) {
+	assert((int)row_ptr.size() == m + 1 && col_idx.size() == vals.size() && row_ptr[m] == (int)vals.size());
+	this->rows = m;
+	this->cols = n;
+	this->row_ptr = std::move(row_ptr);
+	this->col_idx = std::move(col_idx);
+	this->vals = std::move(vals);
+}
+
+/*
+* Compresses a dense matrix, keeping its nonzero entries.
+*/
+template<typename F>
+sparse_matrix<F>::sparse_matrix(const matrix<F>& A) : row_ptr(A.get_rows() + 1, 0) {
+	this->rows = A.get_rows();
+	this->cols = A.get_cols();
+
+	for (int i = 0; i < rows; i++) {
+		const F* row = A[i];
+		for (int j = 0; j < cols; j++) {
+			if (row[j] != (F)0) {
+				col_idx.push_back(j);
+				vals.push_back(row[j]);
+			}
+		}
+		row_ptr[i + 1] = (int)col_idx.size();
+	}
+}
+
+//OPERATORS
+
+/*
+* Entry lookup by binary search within the row.
+*/
+template<typename F>
+F sparse_matrix<F>::operator () (int i, int j) const {
+	const int* begin = row_cols(i);
+	const int* end = begin + row_size(i);
+	const int* it = std::lower_bound(begin, end, j);
+
+	if (it == end || *it != j) {
+		return (F)0;
+	}
+	return row_vals(i)[it - begin];
+}
+
+/*
+* Sparse-dense product.  Each nonzero a_ik adds a_ik times row k of B to row i of
+* the result, so B is read a row at a time.  For a column vector B this is SpMV.
+*/
+template<typename F>
+matrix<F> sparse_matrix<F>::operator * (const matrix<F>& B) const {
+	assert(cols == B.get_rows());
+
+	int n = B.get_cols();
+	matrix<F> out(rows, n);
+
+	for (int i = 0; i < rows; i++) {
+		F* out_i = out[i];
+		for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++) {
+			F a = vals[k];
+			const F* b_k = B[col_idx[k]];
+			for (int j = 0; j < n; j++) {
+				out_i[j] += a * b_k[j];
+			}
+		}
+	}
+	return out;
+}
+
+/*
+* Sparse matrix-vector product.
+*/
+template<typename F>
+std::vector<F> sparse_matrix<F>::operator * (const std::vector<F>& x) const {
+	assert(cols == (int)x.size());
+
+	std::vector<F> y(rows);
+	for (int i = 0; i < rows; i++) {
+		F sum = 0;
+		for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++) {
+			sum += vals[k] * x[col_idx[k]];
+		}
+		y[i] = sum;
+	}
+	return y;
+}
+
+template<typename F>
+bool sparse_matrix<F>::operator == (sparse_matrix const& other) const {
+	return rows == other.rows && cols == other.cols && row_ptr == other.row_ptr
+		&& col_idx == other.col_idx && vals == other.vals;
+}
+
+//SHIT
+
+/*
+* Expands into a dense matrix.
+*/
+template<typename F>
+matrix<F> sparse_matrix<F>::dense() const {
+	matrix<F> A(rows, cols);
+
+	for (int i = 0; i < rows; i++) {
+		F* row = A[i];
+		for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++) {
+			row[col_idx[k]] = vals[k];
+		}
+	}
+	return A;
+}
+
+/*
+* Returns transpose of matrix, by counting sort on column indices.  Rows of the
+* result come out sorted since rows of this matrix are visited in order.
+*/
+template<typename F>
+sparse_matrix<F> sparse_matrix<F>::t() const {
+	sparse_matrix<F> T(cols, rows);
+	T.col_idx.resize(vals.size());
+	T.vals.resize(vals.size());
+
+	for (int c : col_idx) {
+		T.row_ptr[c + 1]++;
+	}
+	for (int j = 0; j < cols; j++) {
+		T.row_ptr[j + 1] += T.row_ptr[j];
+	}
+
+	std::vector<int> next(T.row_ptr.begin(), T.row_ptr.end() - 1);
+	for (int i = 0; i < rows; i++) {
+		for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++) {
+			int dst = next[col_idx[k]]++;
+			T.col_idx[dst] = i;
+			T.vals[dst] = vals[k];
+		}
+	}
+	return T;
+}
+
+/*
+* Returns the square submatrix whose row and column indices both appear in the
+* given list, in list order.
+*/
+template<typename F>
+sparse_matrix<F> sparse_matrix<F>::select(const int* indices, int num_indices) const {
+	std::vector<triplet<F>> entries;
+
+	for (int x = 0; x < num_indices; x++) {
+		int i = indices[x];
+		const int* cols_i = row_cols(i);
+		const F* vals_i = row_vals(i);
+		for (int k = 0; k < row_size(i); k++) {
+			for (int y = 0; y < num_indices; y++) {
+				if (indices[y] == cols_i[k]) {
+					entries.push_back({ x, y, vals_i[k] });
+				}
+			}
+		}
+	}
+	return sparse_matrix<F>(num_indices, num_indices, entries);
+}
+
+#endif
@@ -1,5 +1,6 @@
 #pragma once
 #include "matrix.h"
+#include "fixed_matrix.h"
 #include "matrixutils.h"
 #include "misc_algebra.h"
 #include <vector>
@@ -22,27 +23,21 @@ public:
 
 	/*
 	* Initializes subspace from list of vectors.
-	* Should be linearly independent.
+	* Dependent vectors are dropped, so dim is the rank of the list.
 	*/
 	subspace(std::initializer_list<vec> list) { 
-		dim = 0;
-		for (vec v : list) {
-			basis.push_back(v);
-			dim++;
-		}
-		this->basis = orthonormalize<parent>(this->basis);
+		basis.assign(list.begin(), list.end());
+		dim = orthonormalize_in_place<parent>(basis.data(), (int)basis.size());
+		basis.resize(dim);
 	} 
 
 	/*
 	* Initializes subspace from std::vector of vectors.
 	*/
 	subspace(std::vector<vec> list) {
-		dim = 0;
-		for (vec v : list) {
-			basis.push_back(v);
-			dim++;
-		}
-		this->basis = orthonormalize<parent>(this->basis);
+		basis = std::move(list);
+		dim = orthonormalize_in_place<parent>(basis.data(), (int)basis.size());
+		basis.resize(dim);
 	}
 
 	/*
@@ -78,7 +73,7 @@ template<typename parent>
 class hyperplane : public subspace<parent> {
 	using K = typename parent::field;
 	using vec = class parent::elem;
-	using mat = matrix<K>;
+	using mat = fixed_matrix<K, parent::dim - 1, parent::dim>;
 
 private:
 	vec normal;
@@ -89,11 +84,11 @@ public:
 		this->dim = 0;
 	}
 
-	hyperplane(vec normal, std::vector<mat> basis) {
+	hyperplane(vec normal, std::vector<vec> basis) {
 		this->normal = normal;
 		this->basis = basis;
 		this->dim = parent::dim - 1;
-		this->lower_dim_proj = mat(basis).t();
+		this->lower_dim_proj = fixed_matrix<K, parent::dim, parent::dim - 1>(basis).t();
 	}
 
 	hyperplane(vec normal) {
@@ -108,13 +103,13 @@ public:
 
 		//this is basically all we need, since we mostly use 2d planes
 		if (dim == 3) {
-			vec p1 = R3::cross_prod(normal, mat({ 0,0,1 }));
+			vec p1 = R3::cross_prod(normal, vec({ 0,0,1 }));
 			vec p2 = R3::cross_prod(p1, normal);
 			plane = vector<vec>(2); 
 			plane[0] = p1; plane[1] = p2;
 
 			this->basis = plane;
-			this->lower_dim_proj = mat(plane).t();
+			this->lower_dim_proj = fixed_matrix<K, parent::dim, parent::dim - 1>(plane).t();
 		}
 
 		//if we need to generate a basis for an arbitrary hyperplane
@@ -122,22 +117,21 @@ public:
 			if (coefficient(i) != 0) {
 				for (int j = 0; j < dim; j++) {
 
-					vector<K> u(dim); for (int j = 0; j < dim; j++) { u[j] = 0; } u[i] = 1;
+					vec u = vec::std_basis(i);
 
 					if (plane.size() >= dim - 1) { break; }
 
 					if (i != j) {
 
 						if (coefficient(j) == 0) {
-							u[i] = 0;
-							u[j] = 1;
+							u[i][0] = 0;
+							u[j][0] = 1;
 						}
 						else {
-							u[j] = (-1) * (static_cast<double>(coefficient(i)) / static_cast<double>(coefficient(j)));
+							u[j][0] = (-1) * (static_cast<double>(coefficient(i)) / static_cast<double>(coefficient(j)));
 						}
 
-						mat test = mat(u);
-						if (!(test == normal)) {
+						if (!(u == normal)) {
 							//u = (test * (-1)).t().get_arr()[0];
 							plane.push_back(u);
 							//i++;
@@ -146,10 +140,21 @@ public:
 				}
 			}
 		}
-		plane = orthonormalize<parent>(plane);
+		int rank = orthonormalize_in_place<parent>(plane.data(), (int)plane.size());
+		plane.resize(rank);
+
+		//degenerate spanning set, complete it from the standard basis
+		if (rank < dim - 1) {
+			plane.insert(plane.begin(), normal);
+			for (int i = 0; i < dim; i++) {
+				plane.push_back(vec::std_basis(i));
+			}
+			rank = orthonormalize_in_place<parent>(plane.data(), (int)plane.size());
+			plane = vector<vec>(plane.begin() + 1, plane.begin() + rank);
+		}
 
 		this->basis = plane;
-		this->lower_dim_proj = mat(plane).t();
+		this->lower_dim_proj = fixed_matrix<K, parent::dim, parent::dim - 1>(plane).t();
 	}
 
 		
@@ -1,7 +1,7 @@
 #include "vertex_shader.h"
+#include "mesh_cache.h"
 #define PI 3.14159265358979323846  /* pi */
 
-using bigint = long long int;
 
 
 static u32 darken(u32 color,double factor) {
@@ -33,11 +33,11 @@ static u32 compute_light_color(u32 light_color, u32 surface_color) {
     return (R_new << 16) | (G_new << 8) | (B_new);
 }
 
-/* for an adjacency matrix A, links i-th and j-th nodes by setting (i,j)-th and
-(j,i)-th entries to 1*/
-void link(int i, int j, matrix<int>* A) {
-    A->set(i, j, 1);
-    A->set(j, i, 1);
+/* for the entries of an adjacency matrix A, links i-th and j-th nodes by setting
+(i,j)-th and (j,i)-th entries to 1*/
+void link(int i, int j, vector<triplet<int>>* A) {
+    A->push_back({ i, j, 1 });
+    A->push_back({ j, i, 1 });
 }
 
 int comp_edge(const void* E1, const void* E2) {
@@ -48,6 +48,22 @@ int comp_face(const void* F1, const void* F2) {
     return (*(face**)F2)->dist_squared - (*(face**)F1)->dist_squared;
 }
 
+//adjacency of a quadrilateral with its vertices listed in order around it
+static const matrix<int> quad_boundary = {
+    {0,1,0,1},
+    {1,0,1,0},
+    {0,1,0,1},
+    {1,0,1,0} };
+
+static vec3 centroid(const vector<vec3>& vertices) {
+    vec3 temp = vertices[0];
+    for (int i = 1; i < (int)vertices.size(); i++) {
+        temp = temp + vertices[i];
+    }
+
+    return temp * (realnum)(1/(double)vertices.size());
+}
+
 static vec centroid(vector<vec> vertices) {
     vec temp = vertices[0];
     for (int i = 1; i < vertices.size(); i++) {
@@ -57,141 +73,171 @@ static vec centroid(vector<vec> vertices) {
     return temp * (1/(double)vertices.size());
 }
 
-bigint factorial(int x) {
-    bigint val = x;
-    while (x > 1) {
-        x--;
-        val *= x;
+//MESH
+wiremesh::wiremesh(vector<vec> vertices, sparse_matrix<int> adjacency_matrix, int vertices_per_face) {
+
+    this->vertices = point_buffer<realnum>(vertices);
+    this->adjacency_matrix = adjacency_matrix;
+    this->pos = centroid(vertices);
+    this->update_bounds();
+
+    for (int i = 0; i < this->size(); i++) {
+        const int* cols = this->adjacency_matrix.row_cols(i);
+        const int* vals = this->adjacency_matrix.row_vals(i);
+        //find edges
+        for (int k = 0; k < this->adjacency_matrix.row_size(i); k++) {
+            if (cols[k] >= i && vals[k]) {
+                this->edges.push_back({ i,cols[k] });
+            }
+        }
     }
-    return val;
-}
 
-bigint nCk(int n, int k) {
-    bigint val = 1;
-    for (int i = 1; i <= k; i++) {
-        val *= (n - k + i);
+    //find faces, the vertex sets each vertex of which is joined to exactly two others
+    csr_graph graph(this->adjacency_matrix);
+    vector<int> cycles;
+    int nfaces = graph_analysis::chordless_cycles(graph, vertices_per_face, cycles);
+
+    //faces keep their vertices in increasing order, and are listed in lexicographic order
+    vector<int> order(nfaces);
+    for (int i = 0; i < nfaces; i++) {
+        int* cycle = cycles.data() + i * vertices_per_face;
+        std::sort(cycle, cycle + vertices_per_face);
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return std::lexicographical_compare(
+            cycles.begin() + a * vertices_per_face, cycles.begin() + (a + 1) * vertices_per_face,
+            cycles.begin() + b * vertices_per_face, cycles.begin() + (b + 1) * vertices_per_face);
+    });
+
+    this->faces.reserve(nfaces, nfaces * vertices_per_face);
+    for (int i : order) {
+        int* vertex_indices = cycles.data() + i * vertices_per_face;
+        this->faces.push_back(vertex_indices, vertices_per_face);
+        unsigned char* adjacency = this->faces.back_adjacency();
+        for (int a = 0; a < vertices_per_face; a++) {
+            for (int b = 0; b < vertices_per_face; b++) {
+                adjacency[a * vertices_per_face + b] = graph.adjacent(vertex_indices[a], vertex_indices[b]);
+            }
+        }
     }
-    return val / factorial(k);
 }
 
-int** generate_all_combinations(int n, int k) {
-
-    bigint m_height = nCk(n, k);
-    int** combos = new int* [m_height];
-    int* nums = new int[k];
-
-    for (int i = 0; i < m_height; i++) combos[i] = new int[k];
-    for (int i = 0; i < k; i++) nums[i] = i + 1;
-    for (int i = 0; i < k; i++)  combos[0][i] = nums[i] - 1;
-
-    bigint combo_num = 1;
-
-    while (nums[0] <= n - k) {
-
-        nums[k - 1]++;
-
-        for (int i = 0; i < k; i++) {
-            if (nums[k - i - 1] > n) {
-
-                int prev = nums[k - i - 2];
+/*
+* Symmetric adjacency matrix of a list of edges (i, j), i < j.  Sorted lists, which
+* is how wiremesh keeps them, are laid out directly: going through the edges in
+* order, every row receives its lower neighbors and then its higher ones in
+* increasing order.  Anything else goes through the triplet constructor.
+*/
+static sparse_matrix<int> edge_adjacency(int n, const vector< std::pair<int,int> >& edges) {
+    bool sorted = true;
+    for (size_t k = 0; k < edges.size() && sorted; k++) {
+        sorted = edges[k].first < edges[k].second && (k == 0 || edges[k - 1] < edges[k]);
+    }
 
-                for (int j = -1; j <= i; j++) {
-                    nums[k - i - 1 + j] = prev + j + 2;
-                }
-            }
+    if (!sorted) {
+        vector<triplet<int>> adjacency;
+        adjacency.reserve(edges.size() * 2);
+        for (const std::pair<int, int>& E : edges) {
+            link(E.first, E.second, &adjacency);
         }
+        return sparse_matrix<int>(n, n, adjacency);
+    }
 
-        if (nums[k - 1] <= n) {
-            for (int i = 0; i < k; i++)  combos[combo_num][i] = nums[i] - 1;
-            combo_num++;
-        }
+    vector<int> row_ptr(n + 1, 0);
+    for (const std::pair<int, int>& E : edges) {
+        row_ptr[E.first + 1]++;
+        row_ptr[E.second + 1]++;
+    }
+    for (int i = 0; i < n; i++) {
+        row_ptr[i + 1] += row_ptr[i];
     }
 
-    return combos;
+    int nnz = row_ptr[n];
+    vector<int> next(row_ptr.begin(), row_ptr.end() - 1);
+    vector<int> col_idx(nnz);
+    for (const std::pair<int, int>& E : edges) {
+        col_idx[next[E.first]++] = E.second;
+        col_idx[next[E.second]++] = E.first;
+    }
+    return sparse_matrix<int>(n, n, std::move(row_ptr), std::move(col_idx), vector<int>(nnz, 1));
 }
 
-face_internal::face_internal(const face_internal& other) {
-    this->adjacency = other.adjacency;
-    this->num_vertices = other.num_vertices;
-    this->vertex_indices = new int[num_vertices];
+wiremesh::wiremesh(point_buffer<realnum> vertices, vector< std::pair<int,int> > edges, face_list faces) {
+
+    this->vertices = std::move(vertices);
+    this->edges = std::move(edges);
+    this->faces = std::move(faces);
+
+    int n = this->size();
+    this->adjacency_matrix = edge_adjacency(n, this->edges);
 
-    for (int i = 0; i < num_vertices; i++) {
-        vertex_indices[i] = other.vertex_indices[i];
+    vec sum = vec::zero();
+    for (int i = 0; i < n; i++) {
+        sum = sum + this->vertices[i];
     }
+    this->pos = sum * (1 / (double)max(n, 1));
+    this->update_bounds();
 }
 
-//MESH
-wiremesh::wiremesh(vector<vec> vertices, matrix<int> adjacency_matrix) {
-
-    this->vertices = vertices;
-    this->adjacency_matrix = adjacency_matrix;
-    this->pos = centroid(vertices);
+void wiremesh::update_bounds() {
+    int n = this->size();
+    if (n == 0) {
+        this->bound_min = this->bound_max = this->bound_center = vec::zero();
+        this->bound_radius = 0;
+        return;
+    }
 
-    for (int i = 0; i < this->size(); i++) {
-        vector<int> row = adjacency_matrix[i];
-        //find edges
-        for (int j = i; j < this->size(); j++) {
-            if (row[j]) {
-                this->edges.push_back({ i,j });
-            }
+    const realnum* coords[3] = { this->vertices.x(), this->vertices.y(), this->vertices.z() };
+    for (int k = 0; k < 3; k++) {
+        realnum lo = coords[k][0];
+        realnum hi = coords[k][0];
+        for (int i = 1; i < n; i++) {
+            lo = min(lo, coords[k][i]);
+            hi = max(hi, coords[k][i]);
         }
+        this->bound_min[k][0] = lo;
+        this->bound_max[k][0] = hi;
     }
 
-    //find faces
-    int vertices_per_face = 4;
-    int ncombos = nCk(this->size(),vertices_per_face);
-    int** vertex_combos = generate_all_combinations(this->size(), vertices_per_face);
-
-    for (int i = 0; i < ncombos; i++) {
-        //partition of adjacency matrix corresponding to a particular combination of vertices
-        matrix<int> adjacency = this->adjacency_matrix.select(vertex_combos[i], vertices_per_face);
-
-        //sum each row of adjacency matrix to get connections for each vertex
-        vector<int> connections_per_vertex(vertices_per_face);
-        for (int j = 0; j < vertices_per_face; j++) {
-            for (int k = 0; k < vertices_per_face; k++) {
-                connections_per_vertex[j] += adjacency[j][k];
-            }
+    //sphere about the center of the box
+    this->bound_center = (this->bound_min + this->bound_max) * 0.5;
+    realnum r2 = 0;
+    for (int i = 0; i < n; i++) {
+        realnum d2 = 0;
+        for (int k = 0; k < 3; k++) {
+            realnum d = coords[k][i] - this->bound_center[k][0];
+            d2 += d * d;
         }
-        
-        auto add_if_face = [&]() {
-            for (int k = 0; k < vertices_per_face; k++) {
-                if (connections_per_vertex[k] != 2) {
-                    return;
-                }
-            }
-            this->faces.push_back(face_internal(vertex_combos[i], vertices_per_face, adjacency));
-            return;
-        };
-        add_if_face();
+        r2 = max(r2, d2);
     }
-
-    delete vertex_combos;
+    this->bound_radius = sqrt(r2);
 }
 
-inline wiremesh wiremesh::operator +=(const vec& v) {
-    for (vec& p : this->vertices) {
-        p = p + v;
-    }
-    this->pos = this->pos + v;
+inline wiremesh& wiremesh::operator +=(const vec& v) {
+    translate_points(v, this->vertices.x(), this->vertices.y(), this->vertices.z(), this->size());
+    this->pos += v;
+    this->bound_min += v;
+    this->bound_max += v;
+    this->bound_center += v;
     return *this;
 }
 
-inline wiremesh wiremesh::operator -=(const vec& v)
+inline wiremesh& wiremesh::operator -=(const vec& v)
 {
-    for (vec& p : this->vertices) {
-        p = p - v;
-    }
-    this->pos = this->pos - v;
+    translate_points(v * -1, this->vertices.x(), this->vertices.y(), this->vertices.z(), this->size());
+    this->pos -= v;
+    this->bound_min -= v;
+    this->bound_max -= v;
+    this->bound_center -= v;
     return *this;
 }
 
-inline wiremesh wiremesh::operator*=(mat T)
+inline wiremesh& wiremesh::operator*=(const mat& T)
 {
-    for (vec& p : this->vertices) {
-        p = T * p;
-    }
+    transform_points(affine_matrix(T), this->vertices.x(), this->vertices.y(), this->vertices.z(), this->size());
     this->pos = T * this->pos;
+    this->update_bounds();
     return *this;
 }
 
@@ -199,144 +245,316 @@ inline wiremesh wiremesh::operator*=(mat T)
 vertex_shader::vertex_shader(draw_device& ddev, camera& cam) { 
 this->ddev = &ddev; 
 this->cam = &cam; 
+this->add_view(cam, ddev);
+}
+
+void vertex_shader::add_view(camera& cam, draw_device& ddev) {
+    this->views.push_back({ &cam, &ddev });
 }
 
 edge vertex_shader::process_edge(vec v1, vec v2, double dist_squared, u32 color){
 
-    vec normal = this->cam->get_normal();
-    vec clip_point = this->cam->get_focal_point() + normal;
-    realnum foc_dist = this->cam->get_foc_dist();
+    realnum p[3] = { v1[0][0], v1[1][0], v1[2][0] };
+    realnum q[3] = { v2[0][0], v2[1][0], v2[2][0] };
+    unsigned char keep;
 
-    bool v1_behind = R3::ip(v1 - clip_point, normal) <= 0;
-    bool v2_behind = R3::ip(v2 - clip_point, normal) <= 0;
+    vec normal = this->cam->get_normal();
+    clip_segments(this->cam->get_focal_point() + normal, normal, p, p + 1, p + 2, q, q + 1, q + 2, &keep, 1);
 
-    if (v1_behind && v2_behind) {
+    if (!keep) {
         return edge({0,0,0},{0,0,0},-1);
     }
 
-    if (v1_behind) {
-        v1 = R3::line_plane_intersect(v1, v2 - v1, clip_point, normal);
+    return edge({ p[0], p[1], p[2] }, { q[0], q[1], q[2] }, dist_squared, color);
+}
+
+void vertex_shader::cull_meshes(vector<wiremesh*>& visible)
+{
+    this->cam->set_viewport(this->ddev->get_width(), this->ddev->get_height());
+    const frustum& view = this->cam->get_frustum();
+
+    visible.clear();
+    for (wiremesh* pmesh : this->meshes) {
+        if (view.sees_sphere(pmesh->get_bound_center(), pmesh->get_bound_radius()) &&
+            view.sees_box(pmesh->get_bound_min(), pmesh->get_bound_max())) {
+            visible.push_back(pmesh);
+        }
     }
+}
 
-    if (v2_behind) {
-        v2 = R3::line_plane_intersect(v2, v2 - v1, clip_point, normal);
+int vertex_shader::clip_edges(point_buffer<realnum>& starts, point_buffer<realnum>& ends, unsigned char* keep)
+{
+    vec normal = this->cam->get_normal();
+    return clip_segments(this->cam->get_focal_point() + normal, normal, starts, ends, keep);
+}
+
+face vertex_shader::build_face(const face_internal& facedata, wiremesh* pmesh)
+{
+    int npoints = facedata.num_vertices;
+
+    //gather vertices for face
+    const point_buffer<realnum>& pts = pmesh->vertices;
+    vector<vec3> vertices(npoints);
+    for (int i = 0; i < npoints; i++) {
+        int v = facedata.vertex_indices[i];
+        vertices[i] = vec3(pts.x()[v], pts.y()[v], pts.z()[v]);
     }
 
-    return edge(v1, v2, dist_squared, color);
+    face F(vertices, centroid(vertices), 0, pmesh, pmesh->color);
+
+    //ensure surface normal points outwards from shape. 
+    //if (R3::ip(surface_normal,F->midpoint - ((wiremesh*)(F->mesh))->get_pos()) < 0) {
+        F.normal = F.surface_normal() * (realnum)-1;
+    //}
+
+    //cheap shader
+    double brightness = 0;
+    for (light* L : this->lights) {
+        double dist;
+        vec3 light_ray = L->process_ray(F.midpoint, &dist);
+        double light_level = (R3::ip(F.normal, light_ray) * (1 / pow(1 + dist / L->strength, 2)));
+        brightness += light_level * (light_level < 0);
+    }
+    F.flat_color = darken(F.color, brightness * -1);
+
+    return F;
 }
 
-face vertex_shader::process_face(face_internal facedata,wiremesh* pmesh)
+/*
+* Indices 0..n-1 of the face's vertices in the order they go around its boundary,
+* false if the face's edges don't form a single cycle.
+*/
+static bool boundary_order(const face_internal& facedata, int* order)
 {
-    vec normal = this->cam->get_normal();
-    vec clip_point = this->cam->get_focal_point() + normal;
-    realnum foc_dist = this->cam->get_foc_dist();
-    int nvertices = facedata.num_vertices;
+    int n = facedata.num_vertices;
+    int prev = -1;
+    int cur = 0;
+    for (int k = 0; k < n; k++) {
+        order[k] = cur;
+        int next = -1;
+        for (int j = 0; j < n && next < 0; j++) {
+            if (j != cur && j != prev && facedata.adjacency(cur, j)) {
+                next = j;
+            }
+        }
+        if (next < 0 || (next == 0) != (k == n - 1)) {
+            return false;
+        }
+        prev = cur;
+        cur = next;
+    }
+    return true;
+}
 
-    bool* vertex_is_behind = new bool(nvertices);
+void vertex_shader::process_faces(wiremesh* pmesh, vector<face>& faces, const vector<vec2>& projected, vector<face*>& visible)
+{
+    int nfaces = (int)faces.size();
+
+    //lay the boundary edges of every face out in order around the face, and clip
+    //them all at once
+    int nsegments = (int)pmesh->faces.indices.size();
+    this->clip_starts.resize(nsegments);
+    this->clip_ends.resize(nsegments);
+    this->clip_keep.resize(nsegments);
+    this->clip_order.resize(nsegments);
+
+    for (int k = 0; k < nfaces; k++) {
+        face_internal facedata = pmesh->faces[k];
+        int first = pmesh->faces.offsets[k];
+        int* order = this->clip_order.data() + first;
+        int n = facedata.num_vertices;
+
+        //a face that isn't a cycle goes around in the order its vertices are stored
+        if (!boundary_order(facedata, order)) {
+            for (int i = 0; i < n; i++) {
+                order[i] = i;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            const vec3& p = faces[k].vertices_real[order[i]];
+            const vec3& q = faces[k].vertices_real[order[(i + 1) % n]];
+            this->clip_starts.set(first + i, p.x, p.y, p.z);
+            this->clip_ends.set(first + i, q.x, q.y, q.z);
+        }
+    }
+    this->clip_edges(this->clip_starts, this->clip_ends, this->clip_keep.data());
+
+    //the clipped outline goes through the kept part of each edge, with the near
+    //plane closing the gap where the face passes behind the camera
+    vec3 focal_point(this->cam->get_focal_point());
+    const realnum* coords[2][3] = {
+        { this->clip_starts.x(), this->clip_starts.y(), this->clip_starts.z() },
+        { this->clip_ends.x(), this->clip_ends.y(), this->clip_ends.z() } };
+    for (int k = 0; k < nfaces; k++) {
+        face& F = faces[k];
+        face_internal facedata = pmesh->faces[k];
+        int first = pmesh->faces.offsets[k];
+        const int* order = this->clip_order.data() + first;
+        int n = facedata.num_vertices;
+
+        //vertex of the face a point on the outline is (-1 for points on the near
+        //plane), so a corner shared by two edges goes in once
+        int first_vertex = -2;
+        int last_vertex = -2;
+        F.vertices_projected.clear();
+        for (int i = 0; i < n; i++) {
+            int s = first + i;
+            if (!this->clip_keep[s]) {
+                continue;
+            }
+            for (int end = 0; end < 2; end++) {
+                int v = order[(i + end) % n];
+                const vec3& original = F.vertices_real[v];
+                bool moved = coords[end][0][s] != original.x || coords[end][1][s] != original.y ||
+                    coords[end][2][s] != original.z;
+                if (moved) {
+                    v = -1;
+                }
+                else if (v == last_vertex) {
+                    continue;
+                }
 
-    for (int i = 0; i < nvertices; i++) {
-        vertex_is_behind[i] = R3::ip(pmesh->vertices[facedata.vertex_indices[i]] - clip_point, normal);
+                F.vertices_projected.push_back(moved ?
+                    this->cam->proj({ coords[end][0][s], coords[end][1][s], coords[end][2][s] }) :
+                    projected[facedata.vertex_indices[v]]);
+                if (first_vertex == -2) {
+                    first_vertex = v;
+                }
+                last_vertex = v;
+            }
+        }
+        if (F.vertices_projected.size() > 1 && last_vertex >= 0 && last_vertex == first_vertex) {
+            F.vertices_projected.pop_back();
+        }
+
+        //nothing left means the face is behind the camera
+        if (F.vertices_projected.empty()) {
+            F.dist_squared = -1;
+            continue;
+        }
+
+        vec3 midpoint_to_cam = F.midpoint - focal_point;
+        F.dist_squared = R3::ip(midpoint_to_cam, midpoint_to_cam);
+        visible.push_back(&F);
     }
-    delete vertex_is_behind;
-    return face();
 }
 
 void vertex_shader::process_meshes()
+{
+    //cull for every view first, so only meshes some view can see get their faces built
+    vector< vector<wiremesh*> > visible(this->views.size());
+    for (size_t v = 0; v < this->views.size(); v++) {
+        this->cam = this->views[v].cam;
+        this->ddev = this->views[v].ddev;
+        cull_meshes(visible[v]);
+    }
+
+    //world space work (face geometry, normals, lighting) is shared by every view
+    unordered_map<wiremesh*, vector<face>> mesh_face_map;
+    for (const vector<wiremesh*>& seen : visible) {
+        for (wiremesh* pmesh : seen) {
+            if (mesh_face_map.count(pmesh)) {
+                continue;
+            }
+            vector<face>& faces = mesh_face_map[pmesh];
+            faces.reserve(pmesh->faces.size());
+            for (int k = 0; k < pmesh->faces.size(); k++) {
+                faces.push_back(build_face(pmesh->faces[k], pmesh));
+            }
+        }
+    }
+
+    for (size_t v = 0; v < this->views.size(); v++) {
+        this->cam = this->views[v].cam;
+        this->ddev = this->views[v].ddev;
+        render_meshes(visible[v], mesh_face_map);
+    }
+
+    //draw_line and process_edge between frames work in the first view, as they did
+    //before there were several
+    if (!this->views.empty()) {
+        this->cam = this->views[0].cam;
+        this->ddev = this->views[0].ddev;
+    }
+}
+
+void vertex_shader::render_meshes(const vector<wiremesh*>& visible, unordered_map<wiremesh*, vector<face>>& mesh_face_map)
 {
     //double render_dist = 2000;
     vec focal_point = this->cam->get_focal_point();
 
     unordered_map<wiremesh*, vector<edge>> mesh_edge_map;
-    unordered_map<wiremesh*, vector<face>> mesh_face_map;
+    vector<face*> all_faces;
 
     //this adds each edge to a partition of edge_container for its
     //respective mesh
-    for (wiremesh* pmesh: this->meshes) {
-        auto all_projected_vertices = pmesh->vertices;
-        for (vec& v : all_projected_vertices) {
-            v = cam->proj(v);
-        }
+    for (wiremesh* pmesh: visible) {
+        cam->proj_points(pmesh->vertices, this->projected);
 
         vector<edge> edges;
-        vector<face> faces;
 
-        for (auto vertex_pair : pmesh->edges) {
+        //clip all edges of the mesh against the near plane at once
+        int nedges = pmesh->edges.size();
+        point_buffer<realnum>& starts = this->clip_starts;
+        point_buffer<realnum>& ends = this->clip_ends;
+        vector<unsigned char>& keep = this->clip_keep;
+        starts.resize(nedges);
+        ends.resize(nedges);
+        keep.resize(nedges);
+
+        for (int k = 0; k < nedges; k++) {
+            starts.set(k, pmesh->vertices[pmesh->edges[k].first]);
+            ends.set(k, pmesh->vertices[pmesh->edges[k].second]);
+        }
+        edges.reserve(this->clip_edges(starts, ends, keep.data()));
 
-            vec& v1 = pmesh->vertices[vertex_pair.first];
-            vec& v2 = pmesh->vertices[vertex_pair.second];
+        for (int k = 0; k < nedges; k++) {
+            //edges entirely behind the camera are not rendered
+            if (!keep[k]) {
+                continue;
+            }
 
             //the midpoint of v1 and v2 relative to the camera is projected onto 
             // the xy-plane to get cylindrical distance.
-            vec midpoint = proj_xy * ((v1 + v2) * 0.5 - focal_point);
-            double dist_squared = R3::ip(midpoint, midpoint);
+            int a = pmesh->edges[k].first;
+            int b = pmesh->edges[k].second;
+            realnum dx = (pmesh->vertices.x()[a] + pmesh->vertices.x()[b]) * 0.5 - focal_point[0][0];
+            realnum dy = (pmesh->vertices.y()[a] + pmesh->vertices.y()[b]) * 0.5 - focal_point[1][0];
+            double dist_squared = dx * dx + dy * dy;
 
-            //dist_squared of -1 is reserved for when the edge is off-camera. We 
-            // only render edges which are in view
-            if (dist_squared != -1){
-                edges.push_back(process_edge(v1, v2, dist_squared, pmesh->color));
-            }
+            edges.push_back(edge(starts[k], ends[k], dist_squared, pmesh->color));
         }
 
-        for (face_internal facedata : pmesh->faces) {
-            int npoints = facedata.num_vertices;
-
-            //gather vertices for face
-            vector<vec> projected_vertices(npoints);
-            vector<vec> vertices(npoints);
-
-            for (int i = 0; i < npoints; i++) {
-                projected_vertices[i] = all_projected_vertices[facedata.vertex_indices[i]];
-                vertices[i] = pmesh->vertices[facedata.vertex_indices[i]];
-            }
-
-            vec midpoint = centroid(vertices);
-            vec midpoint_to_cam = midpoint - focal_point;
-            double dist_squared = R3::ip(midpoint_to_cam, midpoint_to_cam);
+        //faces that are off-camera are not rendered
+        process_faces(pmesh, mesh_face_map.at(pmesh), this->projected, all_faces);
 
-            faces.push_back(face(projected_vertices,vertices,midpoint,dist_squared,facedata.adjacency,pmesh,pmesh->color));
-        }
-       
-        mesh_face_map.insert({ pmesh,faces });
         mesh_edge_map.insert({ pmesh,edges });
     }
 
-    //All edges in edge_container are then put into a single std::vector and sorted.
-    int num_faces_total = 0;
-    for (wiremesh* pmesh : meshes) {
-        num_faces_total += mesh_face_map.at(pmesh).size();
-    }
-    vector<face*> all_faces(num_faces_total); {
-        int i = 0;
-        for (wiremesh* pmesh : meshes) {
-            for (face& F : mesh_face_map.at(pmesh)) {
-                all_faces[i] = &F;
-                i++;
-            }
-        }
-    }
-
-    // we sort the edges by the square of their distance from the camera and then 
+    // we sort the faces by the square of their distance from the camera and then 
     // draw them in that order.
     qsort(all_faces.data(),all_faces.size(),sizeof(face*), comp_face);
 
+    //takes image plane coordinates back to the camera plane in R3, as the images
+    //of the two axes
+    fixed_matrix<realnum, 3, 2> plane_to_world = this->cam->R2_proj().t();
+    vec3 plane_x(plane_to_world[0][0], plane_to_world[1][0], plane_to_world[2][0]);
+    vec3 plane_y(plane_to_world[0][1], plane_to_world[1][1], plane_to_world[2][1]);
+    vec3 cam_pos(this->cam->get_pos());
+    vec3 focal_point3(focal_point);
+
     for (face* F : all_faces) {
         //handle shading
-     
-        vec surface_normal = F->surface_normal();
-
-        //ensure surface normal points outwards from shape. 
-        //if (R3::ip(surface_normal,F->midpoint - ((wiremesh*)(F->mesh))->get_pos()) < 0) {
-            surface_normal = surface_normal * -1;
-        //}
+        const vec3& surface_normal = F->normal;
         
         //incredibly taxing shader
         auto smooth_shader = [&](int x, int y) {
             //sends point to R3 on camera plane
-            vec camera_plane_pos = this->cam->R2_proj().t() * vec({(double)x,(double)y}) + cam->get_pos();
+            vec3 camera_plane_pos = plane_x * (realnum)x + plane_y * (realnum)y + cam_pos;
             
-            vec point_on_face = R3::line_plane_intersect(
+            vec3 point_on_face = R3::line_plane_intersect(
                 camera_plane_pos,
-                camera_plane_pos - focal_point,
+                camera_plane_pos - focal_point3,
                 F->vertices_real[0],
                 surface_normal
             );
@@ -344,7 +562,7 @@ void vertex_shader::process_meshes()
             u32 light_total = 0;
             for (light* L : this->lights) {
                 double dist;
-                vec light_ray = L->process_ray(point_on_face, &dist);
+                vec3 light_ray = L->process_ray(point_on_face, &dist);
                 dist = dist / L->strength;
                 double power = (1 / pow(1 + dist, 2));
                 double light_level = (R3::ip(surface_normal, light_ray)*power);
@@ -355,23 +573,26 @@ void vertex_shader::process_meshes()
             return compute_light_color(light_total, F->color);
         };   
 
-        //cheap shader
-        double brightness = 0;
-        for (light* L : this->lights) {
-            double dist;
-            vec light_ray = L->process_ray(F->midpoint, & dist);
-            double light_level = (R3::ip(surface_normal, light_ray) * (1 / pow(1 + dist / L->strength, 2)));
-            brightness += light_level * (light_level < 0);
-        }
-        u32 face_color = darken(F->color, brightness*-1);
-
         auto solid_shader = [&](int x, int y) {
-            return face_color;
+            return F->flat_color;
         };
 
-        //draw the face
-        ddev->draw_quadrilateral(F->adjacency, F->vertices_projected, smooth_shader);
-        ddev->draw_line(cam->proj(F->midpoint), cam->proj(F->midpoint + surface_normal * 10), 0x0000FF);
+        //draw the clipped outline.  The rasterizer fills quadrilaterals, shaded, and
+        //triangles in a flat color, so a quad cut by the near plane into a pentagon
+        //is drawn as a quad and a triangle.  Other faces are left unfilled.
+        const vector<vec2>& outline = F->vertices_projected;
+        int noutline = (int)outline.size();
+        if (F->nvertices == 4 || F->nvertices == 3) {
+            int k = 1;
+            if (F->nvertices == 4 && noutline >= 4) {
+                ddev->draw_quadrilateral(quad_boundary, vector<vec2>(outline.begin(), outline.begin() + 4), smooth_shader);
+                k = 3;
+            }
+            for (; k + 1 < noutline; k++) {
+                ddev->draw_triangle(outline[0], outline[k], outline[k + 1], F->flat_color);
+            }
+        }
+        ddev->draw_line(cam->proj(F->midpoint.elem()), cam->proj((F->midpoint + surface_normal * (realnum)10).elem()), 0x0000FF);
         
 
         //ddev->draw_line(cam->proj(E.vertices[0]), cam->proj(E.vertices[2]), E.color);
@@ -390,31 +611,52 @@ void obj_3d::set_pos(vec new_pos) {
     this->pos = new_pos;
 }
 
-void obj_3d::transform(mat T){
-    vec pos = this->get_pos();
-    for (vec& v : this->mesh.vertices) {
-        vec temp = v - pos;
-        v = pos + T * temp;
-    }
+/* rotates the mesh by q about its position */
+void obj_3d::rotate(const quaternion<realnum>& q) {
+    this->transform(q.to_matrix());
+    this->orientation = q * this->orientation;
+    this->orientation.normalize();
+}
+
+void obj_3d::set_orientation(const quaternion<realnum>& q) {
+    this->rotate(q * this->orientation.conj());
 }
 
-void obj_3d::affine_transform(mat T) {
+void obj_3d::transform(const mat& T){
+    //v -> T(v - pos) + pos
     vec pos = this->get_pos();
-    for (vec& v : this->mesh.vertices) {
-        v = T * v;
-    }
+    point_buffer<realnum>& pts = this->mesh.vertices;
+    transform_points(affine_matrix(T, pos - T * pos), pts.x(), pts.y(), pts.z(), pts.size());
+    this->mesh.update_bounds();
+}
+
+void obj_3d::affine_transform(const mat& T) {
+    point_buffer<realnum>& pts = this->mesh.vertices;
+    transform_points(affine_matrix(T), pts.x(), pts.y(), pts.z(), pts.size());
+    this->mesh.update_bounds();
 }
 
 //SURFACE
 surface::surface(int size, realnum spacing) {
+    this->size = size;
+    std::string key = mesh_cache::key("surface", surface::build_version, { (long double)size, (long double)spacing });
+    if (!mesh_cache::fetch(key, this->mesh)) {
+        this->build(size, spacing);
+        mesh_cache::store(key, this->mesh);
+    }
+    this->pos = mesh.get_pos();
+}
+
+void surface::build(int size, realnum spacing) {
     //don't look at this madness
-    const vec zero = mat::zero(3, 1);
-    const vec e[3] = { mat::std_basis(3,0) , mat::std_basis(3,1), mat::std_basis(3,2) };
+    const vec zero = vec::zero();
+    const vec e[3] = { vec::std_basis(0) , vec::std_basis(1), vec::std_basis(2) };
 
     int nvertices = pow(size, 2);
 
     vector<vec> vertices(nvertices);
-    matrix<int> adjacency = matrix<int>::zero(nvertices, nvertices);
+    vector<triplet<int>> adjacency;
+    adjacency.reserve(nvertices * 8);
 
     for (int i = 0; i < size; i++) {
         for (int j = 0; j < size; j++) {
@@ -433,17 +675,15 @@ surface::surface(int size, realnum spacing) {
             }
         }
     }
-    this->size = size;
-    this->mesh = wiremesh(vertices, adjacency);
-    this->pos = mesh.get_pos();
+    this->mesh = wiremesh(vertices, sparse_matrix<int>(nvertices, nvertices, adjacency));
 }
 
 //CUBE
 cube::cube(realnum side_length, vec pos){
-    vec zero = vec::zero(3, 1);
-    vec e[3] = { mat::std_basis(3,0) , mat::std_basis(3,1), mat::std_basis(3,2) };
+    vec zero = vec::zero();
+    vec e[3] = { vec::std_basis(0) , vec::std_basis(1), vec::std_basis(2) };
 
-    matrix<int> adjacency = matrix<int>({
+    sparse_matrix<int> adjacency = sparse_matrix<int>(matrix<int>({
         {0,1,1,1,0,0,0,0},
         {1,0,0,0,1,0,1,0},
         {1,0,0,0,1,1,0,0},
@@ -452,7 +692,7 @@ cube::cube(realnum side_length, vec pos){
         {0,0,1,1,0,0,0,1},
         {0,1,0,1,0,0,0,1},
         {0,0,0,0,1,1,1,0}
-    }).t();
+    }).t());
 
     int nvertices = adjacency.get_rows();
     vector<vec> vertices(nvertices);
@@ -482,8 +722,18 @@ bool cube::is_inside(vec P)
 //SPHERE
 sphere::sphere(realnum r, int res, vec pos) {
     this->r = r;
-    this->pos = pos;
 
+    //built around the origin, so the cached mesh serves every position
+    std::string key = mesh_cache::key("sphere", sphere::build_version, { (long double)r, (long double)res });
+    if (!mesh_cache::fetch(key, this->mesh)) {
+        this->build(r, res);
+        mesh_cache::store(key, this->mesh);
+    }
+    this->mesh.mov_to(pos);
+    this->pos = mesh.get_pos();
+}
+
+void sphere::build(realnum r, int res) {
     vector<vec> vertices;
 
     int size = res * 4; // amount of vertices per halfcircle
@@ -491,19 +741,21 @@ sphere::sphere(realnum r, int res, vec pos) {
     realnum theta = PI / (2 * res);
     vec axis = {0,0,r};
 
-    vertices.push_back(axis + pos);
+    vertices.push_back(axis);
     for (int i = 0; i < size; i++) {
+        quaternion<realnum> yaw = R3::rotate_intr_q(theta * i, 0, 0);
         for (int j = 1; j < size/2; j++) {
-            vec point = R3::rotate_intr(theta * i, theta * j, 0) * axis + pos;
+            vec point = (yaw * R3::rotate_intr_q(0, theta * j, 0)).rotate(axis);
             vertices.push_back(point);
         }
     }
-    vec top = R3::rotate_intr(0, PI, 0) * axis  + pos;
+    vec top = R3::rotate_intr_q(0, PI, 0).rotate(axis);
     vertices.push_back(top);
     int nvertices = vertices.size();
 
     //this matrix tells us which vertices are connected
-    matrix<int> adjacency = matrix<int>::zero(nvertices,nvertices);
+    vector<triplet<int>> adjacency;
+    adjacency.reserve(res * 4 * res * 2 * 4);
 
     for (int i = 0; i < res * 4; i++) {
         for (int j = 0; j < res * 2; j++) {
@@ -529,16 +781,15 @@ sphere::sphere(realnum r, int res, vec pos) {
         }
     }
     
-    this->mesh = wiremesh(vertices, adjacency);
-    this->mesh.mov_to(pos);
-    this->pos = mesh.get_pos();
-
+    this->mesh = wiremesh(vertices, sparse_matrix<int>(nvertices, nvertices, adjacency));
 }
 
 void sphere::draw_vertices(draw_device ddev, camera cam)
 {
-    for (vec p : this->mesh.vertices) {
-        ddev.draw_circ(cam.proj(p),3.4,0x00FFFF);
+    vector<vec2> projected;
+    cam.proj_points(this->mesh.vertices, projected);
+    for (vec2 p : projected) {
+        ddev.draw_circ(p,3.4,0x00FFFF);
     }
     return;
 }
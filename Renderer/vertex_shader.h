@@ -2,6 +2,7 @@
 #include "draw_device.h"
 #include "linked_node.h"
 #include "camera.h"
+#include "graph_analysis.h"
 #include <unordered_map>
 #include <tuple>
 
@@ -32,86 +33,154 @@ struct face {
     face() {}
 
     face(
-        vector<vec> vertices_projected,
-        vector<vec> vertices_real,
-        vec midpoint,
+        vector<vec3> vertices_real,
+        vec3 midpoint,
         double dist_squared,
-        matrix<int> adjacency, 
         void* mesh,
         u32 color = 0xFFFFFF
     ) {
-        this->vertices_projected = vertices_projected;
         this->vertices_real = vertices_real;
         this->color = color;
-        this->adjacency = adjacency;
         this->dist_squared = dist_squared;
         this->midpoint = midpoint;
         this->mesh = mesh;
-        this->nvertices = vertices_projected.size();
+        this->nvertices = vertices_real.size();
     }
 
-    vec surface_normal() {
-        vec v1 = this->vertices_real[1] - this->vertices_real[0];
-        vec v2 = this->vertices_real[3] - this->vertices_real[0];
+    vec3 surface_normal() {
+        vec3 v1 = this->vertices_real[1] - this->vertices_real[0];
+        vec3 v2 = this->vertices_real[this->nvertices - 1] - this->vertices_real[0];
 
-        vec surface_normal = R3::cross_prod(v2, v1);
+        vec3 surface_normal = R3::cross_prod(v2, v1);
 
-        return surface_normal * pow(R3::norm(surface_normal), -1);
+        return surface_normal * (realnum)pow(R3::norm(surface_normal), -1);
 
     }
 
     u32 color;
     double dist_squared;
-    matrix<int> adjacency;
-    vector<vec> vertices_projected;
-    vector<vec> vertices_real;
-    vec midpoint;
+    //outline of the face as seen by the current camera, in order around it and
+    //clipped to the near plane
+    vector<vec2> vertices_projected;
+    vector<vec3> vertices_real;
+    vec3 midpoint;
     int nvertices;
     void* mesh;
+
+    //outward unit normal, and color lit at the midpoint
+    vec3 normal;
+    u32 flat_color;
 };
 
-/*Face comprised of n vertices, to be used for reference inside a mesh object.*/
+/*
+* Face comprised of n vertices, to be used for reference inside a mesh object.  A view
+* into the mesh's face_list, valid until the list changes.
+*/
 struct face_internal {
-    face_internal() {}
-    face_internal(const face_internal& other);
+    const int* vertex_indices;
+    int num_vertices;
+    //num_vertices x num_vertices, row major
+    const unsigned char* adjacency_data;
 
-    face_internal(int* vertex_indices,int num_vertices, matrix<int> adjacency) {
-        this->vertex_indices = new int[num_vertices];
+    //whether the i-th and j-th vertices of the face are joined by an edge
+    bool adjacency(int i, int j) const { return this->adjacency_data[i * this->num_vertices + j] != 0; }
+};
 
-        for (int i = 0; i < num_vertices; i++) {
-            this->vertex_indices[i] = vertex_indices[i];
-        }
+/*
+* The faces of a mesh, stored flat so a mesh holds four arrays rather than one
+* allocation per face.  Face k has the vertices indices[offsets[k]] up to
+* indices[offsets[k + 1]], and its adjacency is the size x size block of adjacency
+* starting at adjacency_offsets[k].
+*/
+struct face_list {
+    vector<int> offsets = { 0 };
+    vector<int> indices;
+    vector<int> adjacency_offsets = { 0 };
+    vector<unsigned char> adjacency;
+
+    int size() const { return (int)this->offsets.size() - 1; }
+
+    face_internal operator [] (int k) const {
+        return { this->indices.data() + this->offsets[k], this->offsets[k + 1] - this->offsets[k],
+            this->adjacency.data() + this->adjacency_offsets[k] };
+    }
 
-        this->num_vertices = num_vertices;
-        this->adjacency = adjacency;
+    void reserve(int nfaces, int nindices) {
+        this->offsets.reserve(nfaces + 1);
+        this->indices.reserve(nindices);
+        this->adjacency_offsets.reserve(nfaces + 1);
     }
 
-    matrix<int> adjacency;
-    int* vertex_indices;
-    int num_vertices;
+    //appends a face, its adjacency left empty when not given
+    void push_back(const int* vertex_indices, int num_vertices, const unsigned char* adjacency = nullptr) {
+        this->indices.insert(this->indices.end(), vertex_indices, vertex_indices + num_vertices);
+        this->offsets.push_back((int)this->indices.size());
+
+        int nentries = num_vertices * num_vertices;
+        if (adjacency) {
+            this->adjacency.insert(this->adjacency.end(), adjacency, adjacency + nentries);
+        }
+        else {
+            this->adjacency.resize(this->adjacency.size() + nentries, 0);
+        }
+        this->adjacency_offsets.push_back((int)this->adjacency.size());
+    }
+
+    //adjacency of the face just added
+    unsigned char* back_adjacency() { return this->adjacency.data() + this->adjacency_offsets[this->size() - 1]; }
 };
 
 class wiremesh {
 public:
     wiremesh() {}
-    wiremesh(vector<vec> vertices, matrix<int> adjacency_matrix);
 
-    wiremesh operator += (const vec& v);
-    wiremesh operator -= (const vec& v);
-    wiremesh operator *= (mat T);
+    /*
+    * Mesh of the given vertices and edges.  Faces are the sets of vertices_per_face
+    * vertices joined in a cycle with no other edges between them, so 3 gives a
+    * triangle mesh and 4 a quad mesh.
+    */
+    wiremesh(vector<vec> vertices, sparse_matrix<int> adjacency_matrix, int vertices_per_face = 4);
+
+    /*
+    * Mesh with its edges and faces given outright, e.g. read from a file.  Edges are
+    * (i, j) with i < j, and the adjacency matrix is built from them.
+    */
+    wiremesh(point_buffer<realnum> vertices, vector< std::pair<int,int> > edges, face_list faces);
+
+    wiremesh& operator += (const vec& v);
+    wiremesh& operator -= (const vec& v);
+    wiremesh& operator *= (const mat& T);
 
     vec get_pos() { return this->pos; }
-    void mov_to(vec v) { *this += v - this->pos; this->pos = v; }
+    void mov_to(const vec& v) { *this += v - this->pos; this->pos = v; }
     int size() { return this->vertices.size(); };
 
-    matrix<int> adjacency_matrix;
-    vector<vec> vertices;
+    /*
+    * Bounding box and bounding sphere of the vertices.  The operators above keep
+    * them current; anything writing to vertices directly has to call update_bounds.
+    */
+    void update_bounds();
+    vec get_bound_min() { return this->bound_min; }
+    vec get_bound_max() { return this->bound_max; }
+    vec get_bound_center() { return this->bound_center; }
+    realnum get_bound_radius() { return this->bound_radius; }
+
+    sparse_matrix<int> adjacency_matrix;
+    point_buffer<realnum> vertices;
     vector< std::pair<int,int> > edges;
-    vector<face_internal> faces;
+    face_list faces;
 
     u32 color = 0xAA10FF;
 private:
+    //binary mesh files keep pos and bounds as they are, see mesh_cache.h
+    friend bool save_mesh_file(const char* path, wiremesh& mesh);
+    friend bool load_mesh_file(const char* path, wiremesh& mesh);
+
     vec pos;
+    vec bound_min;
+    vec bound_max;
+    vec bound_center;
+    realnum bound_radius = 0;
 };
 
 class light {
@@ -133,6 +202,12 @@ public:
         return ray * (1 / (*dist));
     }
 
+    vec3 process_ray(const vec3& contact_point, double* dist) {
+        vec3 ray = contact_point - vec3(this->source);
+        *dist = R3::norm(ray);
+        return ray * (realnum)(1 / (*dist));
+    }
+
     vec get_source(){return this->source;}
     void set_pos(vec v) { this->source = v; }
 
@@ -144,6 +219,14 @@ private:
 
 };
 
+/*
+* A camera and the device its image is drawn to.
+*/
+struct render_view {
+    camera* cam;
+    draw_device* ddev;
+};
+
 class vertex_shader {
 
 public:
@@ -151,10 +234,22 @@ public:
     vertex_shader() {}
     vertex_shader(draw_device& ddev, camera& cam);
 
+    /*
+    * Adds another camera to render the scene from.  Each call to process_meshes draws
+    * every view, doing world space work once and only projection and rasterization per view.
+    */
+    void add_view(camera& cam, draw_device& ddev);
+
 
     /* ---------- RENDERING PIPELINE OPERATIONS ----------- */
     edge process_edge(vec v1, vec v2, double dist_squared, u32 color = 0xFFFFFF);
-    face process_face(face_internal facedata,wiremesh* pmesh);
+    face build_face(const face_internal& facedata, wiremesh* pmesh);
+    /*
+    * Clips the boundaries of a mesh's faces to the near plane as one batch, leaving
+    * each face's projected outline in vertices_projected.  Faces with anything left
+    * are added to visible.
+    */
+    void process_faces(wiremesh* pmesh, vector<face>& faces, const vector<vec2>& projected, vector<face*>& visible);
     void process_meshes();
 
     /* ---------- OTHER ---------- */
@@ -163,10 +258,27 @@ public:
     void draw_line(vec v1, vec v2, u32 color = 0xFFFFFF);
 
 private:
-    
+    //draws the visible meshes, their faces built by process_meshes, as seen by the current camera
+    void render_meshes(const vector<wiremesh*>& visible, unordered_map<wiremesh*, vector<face>>& mesh_face_map);
+
+    //meshes whose bounds intersect the current camera's view
+    void cull_meshes(vector<wiremesh*>& visible);
+
+    //clips segments to the camera's near plane, see clip_segments
+    int clip_edges(point_buffer<realnum>& starts, point_buffer<realnum>& ends, unsigned char* keep);
+
     vector<wiremesh*> meshes; 
     vector<light*> lights;
+    vector<render_view> views;
 
+    //scratch for clipping and projection, kept between frames so they don't allocate
+    point_buffer<realnum> clip_starts;
+    point_buffer<realnum> clip_ends;
+    vector<unsigned char> clip_keep;
+    vector<int> clip_order;
+    vector<vec2> projected;
+
+    //view being rendered
     draw_device* ddev;
     camera* cam;
 
@@ -178,16 +290,21 @@ class obj_3d {
 
 protected: 
     vec pos;
+    //rotation applied to the mesh since it was built
+    quaternion<realnum> orientation;
 public:
     //constructors
     obj_3d(){}
     
     //member functions
     inline vec get_pos() {return mesh.get_pos(); }
+    inline quaternion<realnum> get_orientation() { return orientation; }
     void set_pos(vec new_pos);
+    void set_orientation(const quaternion<realnum>& q);
     void set_scale(double scale);
-    void transform(mat T);
-    void affine_transform(mat T);
+    void rotate(const quaternion<realnum>& q);
+    void transform(const mat& T);
+    void affine_transform(const mat& T);
 
     template<typename func>
     void transform(func F);
@@ -205,6 +322,11 @@ public:
     template<typename func>
     void eval(func f, realnum scale = 1);
 private:
+    //part of the mesh cache key, bump it whenever build() or the face detection it
+    //relies on changes what comes out
+    static const int build_version = 1;
+    void build(int size, realnum spacing);
+
     int size;
     realnum spacing;
 };
@@ -227,6 +349,10 @@ public:
     sphere(realnum r, int res, vec pos = { 0,0,0 });
     void draw_vertices(draw_device ddev,camera cam);
 private:
+    //see surface::build_version
+    static const int build_version = 1;
+    void build(realnum r, int res);
+
     realnum r;
 };
 
@@ -236,19 +362,18 @@ inline void surface::eval(func f, realnum scale) {
         for (int j = 0; j < size; j++) {
             realnum x = (i - size / 2) * scale;
             realnum y = (j - size / 2) * scale;
-            vec point = this->mesh.vertices[i * size + j];
-
-            this->mesh.vertices[i * size + j] = {point[0][0],point[1][0],f(x,y)};
+            this->mesh.vertices.z()[i * size + j] = f(x,y);
         }
     }
+    this->mesh.update_bounds();
 }
 
 template<typename func>
 void obj_3d::transform(func F) {
     vec pos = this->get_pos();
-    for (vec& v : this->mesh.vertices) {
-        vec temp = v - pos;
-        v = pos + F(temp);
+    for (int i = 0; i < this->mesh.size(); i++) {
+        this->mesh.vertices.set(i, F(this->mesh.vertices[i] - pos) + pos);
     }
+    this->mesh.update_bounds();
 }
 
@@ -3,8 +3,9 @@
 #endif 
 
 #include "window.h"
+#include "mesh_cache.h"
 
-using mat = matrix<realnum>;
+using mat = fixed_matrix<realnum, 3, 3>;
 using vec = R3::elem;
 using vertex = linked_node<vec>;
 
@@ -34,6 +35,9 @@ int CLIENT_HEIGHT;
 //Main window
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow)
 {
+    //generated meshes are kept between runs
+    CreateDirectoryA("mesh_cache", NULL);
+    mesh_cache::set_directory("mesh_cache");
    
     RenderWindow win;
     if (!win.Create(
@@ -191,7 +195,7 @@ LRESULT RenderWindow::handle_create() {
         for (int i = -bounds[0]; i < bounds[0]; i++) {
             for (int j = -bounds[1]; j < bounds[1]; j++) {
                 for (int k = 0; k < bounds[2]; k++) {
-                   vec pos = vec({ (double)i, (double)j, (double)k }) * cube_size;
+                   vec pos = vec({ (realnum)i, (realnum)j, (realnum)k }) * cube_size;
                    double yes = (double)(rand() % 100) / 100;
     
                    if (yes > 0.98) {
@@ -236,7 +240,7 @@ LRESULT RenderWindow::handle_create() {
                     double y = rand();
                     double z = rand();
 
-                    vec point = { x,y,z };
+                    vec point = { (realnum)x,(realnum)y,(realnum)z };
                     point_field.push_back(point);
                     auto brightness = elec_dist(point);
                     bool neg = brightness < 0;
@@ -410,7 +414,7 @@ LRESULT RenderWindow::update_cam() {
     vcam_real = { vcam_real[0][0], vcam_real[1][0],0 };
 
     //change of basis matrix from camera-relative coordinates to standard basis coordinates
-    mat CoB = mat(vector<mat>({ R3::unitize(proj_xy * cam.get_normal()), R3::unitize(proj_xy * cam.get_plane()[0]), {0,0,1} }));
+    mat CoB = mat({ R3::unitize(proj_xy * cam.get_normal()), R3::unitize(proj_xy * cam.get_plane()[0]), {0,0,1} });
 
     //colliding if new_pos is inside the cube
     bool colliding = false;
@@ -431,15 +435,15 @@ LRESULT RenderWindow::update_cam() {
             bool is_vertical = (cosz >= ROOT2 / 2) + (cosz <= -ROOT2 / 2);
 
             vec direction = {
-                (double)in_x_quadrant * !is_vertical,
-                (double)in_y_quadrant * !is_vertical,
-                (double)is_vertical
+                (realnum)in_x_quadrant * !is_vertical,
+                (realnum)in_y_quadrant * !is_vertical,
+                (realnum)is_vertical
             };
 
             mat signs = {
-                {(double)sign(cosx),0,0},
-                {0,(double)sign(cosy),0},
-                {0,0,(double)sign(cosz)}
+                {(realnum)sign(cosx),0,0},
+                {0,(realnum)sign(cosy),0},
+                {0,0,(realnum)sign(cosz)}
             };
             
             vec plane_normal = signs * direction;
@@ -150,8 +150,8 @@ public:
     BOOL SHOWMENU = false;
 
     //useful things for calculations
-    const vec zero = vec::zero(3, 1);
-    const vec e[3] = { vec::std_basis(3,0) , vec::std_basis(3,1), vec::std_basis(3,2) };
+    const vec zero = vec::zero();
+    const vec e[3] = { vec::std_basis(0) , vec::std_basis(1), vec::std_basis(2) };
     const mat proj_xy = {
             {1,0,0},
             {0,1,0},